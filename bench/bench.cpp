@@ -0,0 +1,310 @@
+// 统计每次时间推进处理的行数和估计字节数，见TickStats
+#define ROBOT_TICK_STATS
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "match_runner.h"
+#include "reference_robot_manager.h"
+#include "robot_manager.h"
+#include "workload.h"
+
+// 基准测试：生成合成指令流，分别测量每种时间推进方式的整体吞吐量、各处理函数的单次耗时，
+// 以及每次时间推进处理的行数和估计读写的字节数，并与原先的布局在同一指令流上的估计值对比。
+// 用法：robot_bench [--robots=N] [--teams=N] [--commands=N] [--kill-rate=X] [--revive-rate=X]
+//       [--heat-pressure=X] [--upgrade-rate=X] [--engineer-rate=X] [--density=X] [--seed=N]
+//       [--mode=scan|scheduled|hot-set|all] [--huge-pages] [--dense] [--dump] [--matches=N]
+// --dump只按主程序的输入格式输出指令流，可直接喂给untitled1；--matches把同一指令流当作N场比赛，
+// 改为测量多场比赛运行器在1、2、4……直到CPU核数个线程下的总吞吐量；
+// --huge-pages让机器人对象所在的内存区使用大页；--dense按工作负载的ID范围直接寻址，
+// 与--dump同用时在输入开头写出#dense声明。每次测量前按机器人数预先申请内存
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 丢弃所有输出的流缓冲区，使击毁事件的输出不计入耗时
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize count) override {
+        return count;
+    }
+};
+
+struct BenchOptions {
+    WorkloadOptions workload;
+    std::string mode = "all";
+    bool huge_pages = false;
+    bool dense = false;
+    bool dump = false;
+    uint32_t matches = 0;
+};
+
+// 解析--name=value形式的参数，不认识的参数返回false
+bool ParseArgs(int argc, char **argv, BenchOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--dump") {
+            options.dump = true;
+            continue;
+        }
+        if (arg == "--huge-pages") {
+            options.huge_pages = true;
+            continue;
+        }
+        if (arg == "--dense") {
+            options.dense = true;
+            continue;
+        }
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+        std::string name = arg.substr(2, eq - 2);
+        const char *value = argv[i] + eq + 1;
+        WorkloadOptions &workload = options.workload;
+        if (name == "seed") {
+            workload.seed = std::strtoull(value, nullptr, 10);
+        } else if (name == "commands") {
+            workload.commands = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (name == "robots") {
+            workload.robots = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (name == "teams") {
+            workload.teams = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (name == "kill-rate") {
+            workload.kill_rate = std::strtod(value, nullptr);
+        } else if (name == "revive-rate") {
+            workload.revive_rate = std::strtod(value, nullptr);
+        } else if (name == "heat-pressure") {
+            workload.heat_pressure = std::strtod(value, nullptr);
+        } else if (name == "upgrade-rate") {
+            workload.upgrade_rate = std::strtod(value, nullptr);
+        } else if (name == "engineer-rate") {
+            workload.engineer_rate = std::strtod(value, nullptr);
+        } else if (name == "density") {
+            workload.time_density = std::strtod(value, nullptr);
+        } else if (name == "mode") {
+            options.mode = value;
+        } else if (name == "matches") {
+            options.matches = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 连续两次读时钟的开销，从单次计时结果中扣除
+double ClockOverheadNs() {
+    constexpr int kRounds = 100000;
+    auto start = Clock::now();
+    for (int i = 0; i < kRounds; i++) {
+        Clock::now();
+        Clock::now();
+    }
+    std::chrono::duration<double, std::nano> total = Clock::now() - start;
+    return total.count() / kRounds / 2;
+}
+
+// 工作负载的ID范围，与GenerateWorkload一致
+DenseIdRange WorkloadIdRange(const WorkloadOptions &workload) {
+    uint32_t teams = std::max<uint32_t>(1, workload.teams);
+    return {teams, std::max<uint32_t>(1, workload.robots / teams)};
+}
+
+// 按工作负载中的机器人数和工程比例预先申请内存
+void ReserveRobots(RobotManager &manager, const WorkloadOptions &workload) {
+    auto engineers = static_cast<uint32_t>(workload.robots * workload.engineer_rate);
+    manager.Reserve(workload.robots - engineers, engineers);
+}
+
+// 按选项准备管理类：预先申请内存，--dense时设置稠密ID范围
+void PrepareManager(RobotManager &manager, const BenchOptions &options) {
+    ReserveRobots(manager, options.workload);
+    if (options.dense) {
+        manager.SetDenseIds(WorkloadIdRange(options.workload));
+    }
+}
+
+// 整体吞吐量：不做单条计时，统计全部指令的总耗时
+void RunThroughput(const char *name, TickMode mode, const std::vector<Command> &commands,
+                   const BenchOptions &options) {
+    NullBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+    RobotManager manager(mode, DeathWriter(null_out), options.huge_pages);
+    PrepareManager(manager, options);
+    auto start = Clock::now();
+    for (const Command &command: commands) {
+        manager.HandleCommand(command);
+    }
+    manager.FlushOutput();
+    std::chrono::duration<double> seconds = Clock::now() - start;
+    std::printf("%-10s total      %10zu cmds  %10.3f ms  %12.0f cmds/s  %8.1f ns/cmd\n", name, commands.size(),
+                seconds.count() * 1e3, static_cast<double>(commands.size()) / seconds.count(),
+                seconds.count() * 1e9 / static_cast<double>(commands.size()));
+    // 原先的布局每次推进遍历全部存活机器人，每个经shared_ptr读写整个机器人对象；
+    // 存活机器人数由同一指令流得到，两边的字节数都按同一方式估计
+    const TickStats &stats = manager.GetTickStats();
+    double ticks = static_cast<double>(std::max<uint64_t>(stats.ticks, 1));
+    double baseline_rows = static_cast<double>(stats.live_robots) / ticks;
+    double baseline_bytes = baseline_rows *
+                            static_cast<double>(sizeof(std::shared_ptr<reference::BaseRobot>) +
+                                                sizeof(reference::InfantryRobot));
+    double bytes = static_cast<double>(stats.estimated_bytes) / ticks;
+    std::printf("%-10s tick       %10llu ticks %10.1f rows/tick %10.0f est. bytes/tick %6.1f bytes/row\n", name,
+                static_cast<unsigned long long>(stats.ticks), static_cast<double>(stats.rows_visited) / ticks, bytes,
+                stats.rows_visited != 0
+                    ? static_cast<double>(stats.estimated_bytes) / static_cast<double>(stats.rows_visited)
+                    : 0.0);
+    std::printf("%-10s baseline   %10llu ticks %10.1f rows/tick %10.0f est. bytes/tick  %5.1fx fewer bytes\n",
+                name, static_cast<unsigned long long>(stats.ticks), baseline_rows, baseline_bytes,
+                bytes != 0 ? baseline_bytes / bytes : 0.0);
+}
+
+// 各处理函数的单次耗时：时间推进和A/F/H/U分别计时
+void RunPerHandler(const char *name, TickMode mode, const std::vector<Command> &commands, const BenchOptions &options,
+                   double overhead_ns) {
+    enum Slot { kTime, kA, kF, kH, kU, kSlots };
+    const char *slot_names[kSlots] = {"time", "A", "F", "H", "U"};
+    double total_ns[kSlots] = {};
+    uint64_t calls[kSlots] = {};
+
+    NullBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+    RobotManager manager(mode, DeathWriter(null_out), options.huge_pages);
+    PrepareManager(manager, options);
+    for (const Command &command: commands) {
+        auto t0 = Clock::now();
+        manager.HandleTimeChange(command.time);
+        auto t1 = Clock::now();
+        Slot slot;
+        switch (command.cmd) {
+            case 'A':
+                manager.HandleCommandA(command.p1, command.p2, static_cast<RobotType>(command.p3));
+                slot = kA;
+                break;
+            case 'F':
+                manager.HandleCommandF(command.p1, command.p2, command.p3);
+                slot = kF;
+                break;
+            case 'H':
+                manager.HandleCommandH(command.p1, command.p2, command.p3);
+                slot = kH;
+                break;
+            case 'U':
+                manager.HandCommandU(command.p1, command.p2, command.p3);
+                slot = kU;
+                break;
+            default:
+                slot = kSlots;
+                break;
+        }
+        auto t2 = Clock::now();
+        total_ns[kTime] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        calls[kTime]++;
+        if (slot != kSlots) {
+            total_ns[slot] += std::chrono::duration<double, std::nano>(t2 - t1).count();
+            calls[slot]++;
+        }
+    }
+    manager.FlushOutput();
+    for (int slot = 0; slot < kSlots; slot++) {
+        if (calls[slot] == 0) continue;
+        double per_call = std::max(0.0, total_ns[slot] / static_cast<double>(calls[slot]) - overhead_ns);
+        std::printf("%-10s %-10s %10llu calls %10.3f ms  %12.0f calls/s %8.1f ns/call\n", name, slot_names[slot],
+                    static_cast<unsigned long long>(calls[slot]), total_ns[slot] / 1e6,
+                    per_call > 0 ? 1e9 / per_call : 0.0, per_call);
+    }
+}
+
+// 多场比赛的总吞吐量：同一指令流作为matches场比赛，线程数从1开始每次翻倍直到CPU核数
+void RunMatches(const std::vector<Command> &commands, const BenchOptions &options) {
+    std::ostringstream text;
+    if (options.dense) {
+        DenseIdRange range = WorkloadIdRange(options.workload);
+        text << "#dense " << range.teams << ' ' << range.robots << '\n';
+    }
+    WriteWorkload(text, commands);
+    std::string input = text.str();
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    double single_rate = 0;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, max_threads)) {
+        std::vector<std::unique_ptr<NullBuffer> > buffers;
+        std::vector<std::unique_ptr<std::ostream> > outputs;
+        MatchRunner runner(threads);
+        for (uint32_t i = 0; i < options.matches; i++) {
+            buffers.push_back(std::make_unique<NullBuffer>());
+            outputs.push_back(std::make_unique<std::ostream>(buffers.back().get()));
+            runner.AddMatch(std::to_string(i), input.data(), input.data() + input.size(), *outputs.back());
+        }
+        auto start = Clock::now();
+        runner.Run();
+        std::chrono::duration<double> seconds = Clock::now() - start;
+        double rate = static_cast<double>(runner.CommandCount()) / seconds.count();
+        if (threads == 1) {
+            single_rate = rate;
+        }
+        std::printf("matches    %2u threads %6u matches %10.3f ms  %12.0f cmds/s  %5.2fx\n", threads,
+                    options.matches, seconds.count() * 1e3, rate, rate / single_rate);
+        if (threads == max_threads) break;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if (!ParseArgs(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--robots=N] [--teams=N] [--commands=N] [--kill-rate=X] "
+                             "[--revive-rate=X] [--heat-pressure=X] [--upgrade-rate=X] [--engineer-rate=X] "
+                             "[--density=X] [--seed=N] [--mode=scan|scheduled|hot-set|all] [--huge-pages] [--dense] [--dump] "
+                             "[--matches=N]\n", argv[0]);
+        return 1;
+    }
+    std::vector<Command> commands = GenerateWorkload(options.workload);
+    if (options.dump) {
+        if (options.dense) {
+            DenseIdRange range = WorkloadIdRange(options.workload);
+            std::cout << "#dense " << range.teams << ' ' << range.robots << '\n';
+        }
+        WriteWorkload(std::cout, commands);
+        return 0;
+    }
+
+    const WorkloadOptions &workload = options.workload;
+    std::printf("workload: %zu cmds, robots=%u teams=%u kill=%.3f revive=%.3f heat=%.3f upgrade=%.3f "
+                "engineer=%.3f density=%.1f seed=%llu\n", commands.size(), workload.robots, workload.teams,
+                workload.kill_rate, workload.revive_rate, workload.heat_pressure, workload.upgrade_rate,
+                workload.engineer_rate, workload.time_density, static_cast<unsigned long long>(workload.seed));
+    if (options.matches != 0) {
+        RunMatches(commands, options);
+        return 0;
+    }
+    double overhead_ns = ClockOverheadNs();
+    std::printf("clock overhead: %.1f ns (subtracted from per-call figures)\n", overhead_ns);
+
+    struct Engine {
+        const char *name;
+        TickMode mode;
+    };
+    const Engine engines[] = {
+        {"scan", TickMode::kScan}, {"scheduled", TickMode::kScheduled}, {"hot-set", TickMode::kHotSet}
+    };
+    for (const Engine &engine: engines) {
+        if (options.mode != "all" && options.mode != engine.name) continue;
+        RunThroughput(engine.name, engine.mode, commands, options);
+        RunPerHandler(engine.name, engine.mode, commands, options, overhead_ns);
+    }
+    return 0;
+}
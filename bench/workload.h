@@ -0,0 +1,114 @@
+#ifndef UNTITLED1_BENCH_WORKLOAD_H
+#define UNTITLED1_BENCH_WORKLOAD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "command.h"
+#include "robot_key.h"
+
+// 合成负载的参数，比例均为占全部指令的比例，剩余部分为不致命的F指令
+struct WorkloadOptions {
+    // 随机数种子，相同参数和种子生成相同的指令流
+    uint64_t seed = 1;
+    // 开局建机器人之后的指令条数
+    uint32_t commands = 1000000;
+    // 机器人数量和队伍数量，机器人平均分到各队
+    uint32_t robots = 10000;
+    uint32_t teams = 2;
+    // 工程机器人所占比例
+    double engineer_rate = 0.2;
+    // 致命伤害的F指令比例
+    double kill_rate = 0.02;
+    // A指令（新建或复活）比例
+    double revive_rate = 0.05;
+    // H指令比例
+    double heat_pressure = 0.3;
+    // U指令比例
+    double upgrade_rate = 0.01;
+    // 平均每个时刻的指令条数，越大时间推进越稀疏
+    double time_density = 4;
+};
+
+// 可复现的伪随机数发生器（SplitMix64），不依赖标准库分布的实现
+class SplitMix64 {
+public:
+    explicit SplitMix64(uint64_t seed) : state_(seed) {
+    }
+
+    uint64_t Next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, bound)内的整数
+    uint32_t Uniform(uint32_t bound) {
+        return static_cast<uint32_t>(Next() % bound);
+    }
+
+    // [0, 1)内的小数
+    double Real() {
+        return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    uint64_t state_;
+};
+
+// 生成指令流：先在时刻0建好全部机器人，再按参数随机生成A/F/H/U指令
+inline std::vector<Command> GenerateWorkload(const WorkloadOptions &options) {
+    SplitMix64 rng(options.seed);
+    uint32_t teams = options.teams == 0 ? 1 : options.teams;
+    uint32_t per_team = std::max<uint32_t>(1, options.robots / teams);
+    auto robot_type = [&](uint32_t team_id, uint32_t robot_id) {
+        // 类型由双ID决定，使复活指令的类型与击毁前一致
+        uint64_t hash = SplitMix64(RobotKey::Pack(team_id, robot_id).value).Next();
+        return static_cast<uint32_t>(static_cast<double>(hash >> 11) * 0x1.0p-53 < options.engineer_rate);
+    };
+
+    std::vector<Command> commands;
+    commands.reserve(static_cast<size_t>(teams) * per_team + options.commands);
+    for (uint32_t team_id = 0; team_id < teams; team_id++) {
+        for (uint32_t robot_id = 0; robot_id < per_team; robot_id++) {
+            commands.push_back({0, 'A', team_id, robot_id, robot_type(team_id, robot_id)});
+        }
+    }
+
+    uint32_t time = 0;
+    double advance_chance = options.time_density > 1 ? 1 / options.time_density : 1;
+    for (uint32_t i = 0; i < options.commands; i++) {
+        if (rng.Real() < advance_chance) {
+            time++;
+        }
+        uint32_t team_id = rng.Uniform(teams);
+        uint32_t robot_id = rng.Uniform(per_team);
+        double pick = rng.Real();
+        if ((pick -= options.revive_rate) < 0) {
+            commands.push_back({time, 'A', team_id, robot_id, robot_type(team_id, robot_id)});
+        } else if ((pick -= options.kill_rate) < 0) {
+            commands.push_back({time, 'F', team_id, robot_id, 400});
+        } else if ((pick -= options.heat_pressure) < 0) {
+            commands.push_back({time, 'H', team_id, robot_id, 1 + rng.Uniform(300)});
+        } else if ((pick -= options.upgrade_rate) < 0) {
+            commands.push_back({time, 'U', team_id, robot_id, 2 + rng.Uniform(2)});
+        } else {
+            commands.push_back({time, 'F', team_id, robot_id, 1 + rng.Uniform(20)});
+        }
+    }
+    return commands;
+}
+
+// 按主程序的输入格式写出指令流
+inline void WriteWorkload(std::ostream &out, const std::vector<Command> &commands) {
+    out << commands.size() << '\n';
+    for (const Command &command: commands) {
+        out << command.time << ' ' << (command.cmd != 0 ? command.cmd : '?') << ' '
+            << command.p1 << ' ' << command.p2 << ' ' << command.p3 << '\n';
+    }
+}
+
+#endif //UNTITLED1_BENCH_WORKLOAD_H
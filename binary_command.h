@@ -0,0 +1,115 @@
+#ifndef UNTITLED1_BINARY_COMMAND_H
+#define UNTITLED1_BINARY_COMMAND_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#include "command.h"
+
+// 二进制指令格式。文件头：4字节魔数"RBC1"，随后依次是稠密ID范围的队伍数、机器人数（0表示未声明）和指令数，
+// 均为变长整数。每条指令：1字节操作码（指令字母，不认识的指令为0），时刻相对上一条指令的差值，队伍ID，
+// 机器人ID，第三个参数。时刻通常单调不减，但输入允许倒退，所以差值先做zigzag编码再写成变长整数；
+// 其余字段直接写成变长整数。变长整数每字节低7位为数据、最高位表示后面还有字节，小端在前。
+// 队伍ID和机器人ID各写一个变长整数，而不是写成RobotKey那样打包的64位键：打包后队伍ID位于第32位以上，
+// 只要队伍ID不为0，键的变长整数就至少5字节；分开写时小于128的ID各只占1字节，常见的一对ID共2字节
+inline constexpr char kBinaryCommandMagic[4] = {'R', 'B', 'C', '1'};
+
+// 判断[begin, end)是否以二进制格式的魔数开头
+inline bool IsBinaryCommands(const char *begin, const char *end) {
+    return end - begin >= static_cast<long>(sizeof(kBinaryCommandMagic)) &&
+           std::memcmp(begin, kBinaryCommandMagic, sizeof(kBinaryCommandMagic)) == 0;
+}
+
+// 二进制指令写入器
+class BinaryCommandWriter {
+public:
+    explicit BinaryCommandWriter(std::ostream &out) : out_(out) {
+    }
+
+    void WriteHeader(uint32_t dense_teams, uint32_t dense_robots, uint32_t count) {
+        out_.write(kBinaryCommandMagic, sizeof(kBinaryCommandMagic));
+        WriteVarint(dense_teams);
+        WriteVarint(dense_robots);
+        WriteVarint(count);
+    }
+
+    void Write(const Command &command) {
+        out_.put(command.cmd);
+        int64_t delta = static_cast<int64_t>(command.time) - static_cast<int64_t>(last_time_);
+        WriteVarint((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        WriteVarint(command.p1);
+        WriteVarint(command.p2);
+        WriteVarint(command.p3);
+        last_time_ = command.time;
+    }
+
+private:
+    std::ostream &out_;
+    uint32_t last_time_ = 0;
+
+    void WriteVarint(uint64_t value) {
+        char bytes[10];
+        size_t length = 0;
+        while (value >= 0x80) {
+            bytes[length++] = static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        bytes[length++] = static_cast<char>(value);
+        out_.write(bytes, static_cast<std::streamsize>(length));
+    }
+};
+
+// 二进制指令读取器：在内存中原地解码，输入不完整或格式错误时返回false
+class BinaryCommandReader {
+public:
+    BinaryCommandReader(const char *begin, const char *end)
+        : pos_(reinterpret_cast<const uint8_t *>(begin)), end_(reinterpret_cast<const uint8_t *>(end)) {
+    }
+
+    bool ReadHeader(uint32_t &dense_teams, uint32_t &dense_robots, uint32_t &count) {
+        if (!IsBinaryCommands(reinterpret_cast<const char *>(pos_), reinterpret_cast<const char *>(end_))) return false;
+        pos_ += sizeof(kBinaryCommandMagic);
+        return ReadUint32(dense_teams) && ReadUint32(dense_robots) && ReadUint32(count);
+    }
+
+    bool ReadCommand(Command &command) {
+        if (pos_ == end_) return false;
+        command.cmd = static_cast<char>(*pos_++);
+        // 与文本格式一致，只有A/F/H/U是有效指令
+        if (command.cmd != 'A' && command.cmd != 'F' && command.cmd != 'H' && command.cmd != 'U') {
+            command.cmd = 0;
+        }
+        uint64_t zigzag;
+        if (!ReadVarint(zigzag)) return false;
+        auto delta = static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        command.time = static_cast<uint32_t>(static_cast<int64_t>(last_time_) + delta);
+        last_time_ = command.time;
+        return ReadUint32(command.p1) && ReadUint32(command.p2) && ReadUint32(command.p3);
+    }
+
+private:
+    const uint8_t *pos_;
+    const uint8_t *end_;
+    uint32_t last_time_ = 0;
+
+    bool ReadVarint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ == end_) return false;
+            uint8_t byte = *pos_++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool ReadUint32(uint32_t &value) {
+        uint64_t wide;
+        if (!ReadVarint(wide) || wide > UINT32_MAX) return false;
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+};
+
+#endif //UNTITLED1_BINARY_COMMAND_H
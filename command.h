@@ -0,0 +1,13 @@
+#ifndef UNTITLED1_COMMAND_H
+#define UNTITLED1_COMMAND_H
+
+#include <cstdint>
+
+// 一条输入指令：时刻、指令字母和三个参数。不认识的指令字母记为0，只推进时间
+struct Command {
+    uint32_t time;
+    char cmd;
+    uint32_t p1, p2, p3;
+};
+
+#endif //UNTITLED1_COMMAND_H
@@ -0,0 +1,169 @@
+#ifndef UNTITLED1_COMMAND_READER_H
+#define UNTITLED1_COMMAND_READER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include "command.h"
+#include "platform.h"
+
+// 输入读取器：标准输入是普通文件时整体映射到内存，否则（管道等）用大块缓冲区分批读取，
+// 在缓冲区上原地解析无符号整数和指令字母，读取每条指令都不分配内存。
+// 也可以直接解析调用方给出的一段内存，并行解析时每个线程用它解析一段输入
+class CommandReader {
+public:
+    // 解析[begin, end)中的内容，不拥有这段内存
+    CommandReader(const char *begin, const char *end) : file_(nullptr), pos_(begin), end_(end) {
+    }
+
+    explicit CommandReader(std::FILE *file) : file_(file) {
+#ifdef ROBOT_HAVE_MMAP
+        int fd = fileno(file);
+        struct stat info{};
+        off_t offset = lseek(fd, 0, SEEK_CUR);
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && offset >= 0 && info.st_size > offset) {
+            void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, info.st_size, MADV_SEQUENTIAL);
+                mapped_ = static_cast<const char *>(data);
+                mapped_size_ = info.st_size;
+                pos_ = mapped_ + offset;
+                end_ = mapped_ + mapped_size_;
+                return;
+            }
+        }
+#endif
+        buffer_ = std::make_unique<char[]>(kBufferSize);
+        pos_ = end_ = buffer_.get();
+    }
+
+    ~CommandReader() {
+#ifdef ROBOT_HAVE_MMAP
+        if (mapped_ != nullptr) {
+            munmap(const_cast<char *>(mapped_), mapped_size_);
+        }
+#endif
+    }
+
+    CommandReader(const CommandReader &) = delete;
+    CommandReader &operator=(const CommandReader &) = delete;
+
+    // 读取一个无符号整数，输入结束或遇到非数字时返回false
+    bool ReadUint(uint32_t &value) {
+        int c = SkipSpace();
+        if (c < '0' || c > '9') return false;
+        value = 0;
+        while (c >= '0' && c <= '9') {
+            value = value * 10 + static_cast<uint32_t>(c - '0');
+            ++pos_;
+            c = Peek();
+        }
+        return true;
+    }
+
+    // 读取输入开头：可选的稠密ID声明"#dense 队伍数 机器人数"（声明所有ID都在这两个范围内），然后是指令数量。
+    // 没有声明或声明不是#dense时dense_teams、dense_robots为0，表示不启用稠密ID；与BinaryCommandReader::ReadHeader对应。
+    // 读不出指令数量时返回false
+    bool ReadHeader(uint32_t &dense_teams, uint32_t &dense_robots, uint32_t &count) {
+        uint32_t teams = 0;
+        uint32_t robots = 0;
+        ReadDenseHeader(teams, robots);
+        if (!ReadUint(count)) return false;
+        dense_teams = teams;
+        dense_robots = robots;
+        return true;
+    }
+
+    // 跳过空白后是否已到输入末尾
+    bool AtEnd() {
+        return SkipSpace() < 0;
+    }
+
+    // 当前解析位置，只在解析调用方给出的内存或映射的文件时有意义
+    const char *Position() const {
+        return pos_;
+    }
+
+    // 读取一条完整指令，输入不完整时返回false
+    bool ReadCommand(Command &command) {
+        if (!ReadUint(command.time)) return false;
+        // 指令是以空白分隔的一段文本，只有单个字母A/F/H/U才是有效指令
+        int c = SkipSpace();
+        if (c < 0) return false;
+        command.cmd = static_cast<char>(c);
+        size_t length = 0;
+        while (c > ' ') {
+            ++length;
+            ++pos_;
+            c = Peek();
+        }
+        if (length != 1 || (command.cmd != 'A' && command.cmd != 'F' && command.cmd != 'H' && command.cmd != 'U')) {
+            command.cmd = 0;
+        }
+        return ReadUint(command.p1) && ReadUint(command.p2) && ReadUint(command.p3);
+    }
+
+private:
+    // 读取输入开头可选的稠密ID声明"#dense 队伍数 机器人数"，声明所有ID都在这两个范围内。
+    // 输入不以'#'开头时只跳过空白并返回false，声明不完整或不是#dense时也返回false；只在返回true时写入teams和robots
+    bool ReadDenseHeader(uint32_t &teams, uint32_t &robots) {
+        int c = SkipSpace();
+        if (c != '#') return false;
+        static constexpr char kDirective[] = "#dense";
+        size_t length = 0;
+        bool matched = true;
+        while (c > ' ') {
+            matched = matched && length < sizeof(kDirective) - 1 && c == kDirective[length];
+            ++length;
+            ++pos_;
+            c = Peek();
+        }
+        matched = matched && length == sizeof(kDirective) - 1;
+        uint32_t dense_teams;
+        uint32_t dense_robots;
+        if (!(ReadUint(dense_teams) && ReadUint(dense_robots) && matched)) return false;
+        teams = dense_teams;
+        robots = dense_robots;
+        return true;
+    }
+
+    static constexpr size_t kBufferSize = 1 << 20;
+
+    std::FILE *file_;
+    // 内存映射的文件内容
+    const char *mapped_ = nullptr;
+    size_t mapped_size_ = 0;
+    // 非映射模式下的读取缓冲区
+    std::unique_ptr<char[]> buffer_;
+    // 当前解析位置和有效数据末尾
+    const char *pos_ = nullptr;
+    const char *end_ = nullptr;
+
+    // 查看当前字符，缓冲区用完时补充数据，输入结束返回-1
+    int Peek() {
+        if (pos_ == end_ && !Refill()) return -1;
+        return static_cast<unsigned char>(*pos_);
+    }
+
+    // 跳过空白字符，返回第一个非空白字符
+    int SkipSpace() {
+        int c = Peek();
+        while (c >= 0 && c <= ' ') {
+            ++pos_;
+            c = Peek();
+        }
+        return c;
+    }
+
+    // 从文件读取下一批数据，映射模式或输入结束时返回false
+    bool Refill() {
+        if (buffer_ == nullptr) return false;
+        size_t count = std::fread(buffer_.get(), 1, kBufferSize, file_);
+        pos_ = buffer_.get();
+        end_ = pos_ + count;
+        return count > 0;
+    }
+};
+
+#endif //UNTITLED1_COMMAND_READER_H
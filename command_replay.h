@@ -0,0 +1,163 @@
+#ifndef UNTITLED1_COMMAND_REPLAY_H
+#define UNTITLED1_COMMAND_REPLAY_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "command.h"
+#include "command_reader.h"
+#include "platform.h"
+#include "spsc_ring.h"
+
+// 只读方式整体载入的输入文件：能映射时映射到内存，否则一次读入缓冲区
+class MappedInput {
+public:
+    explicit MappedInput(const char *path) {
+#ifdef ROBOT_HAVE_MMAP
+        int fd = open(path, O_RDONLY);
+        if (fd >= 0) {
+            struct stat info{};
+            if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+                void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    madvise(data, info.st_size, MADV_WILLNEED);
+                    mapped_ = static_cast<const char *>(data);
+                    size_ = info.st_size;
+                }
+            }
+            close(fd);
+            if (mapped_ != nullptr) return;
+        }
+#endif
+        std::FILE *file = std::fopen(path, "rb");
+        if (file == nullptr) return;
+        ok_ = true;
+        char chunk[1 << 16];
+        size_t count;
+        while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            buffer_.insert(buffer_.end(), chunk, chunk + count);
+        }
+        std::fclose(file);
+        size_ = buffer_.size();
+    }
+
+    ~MappedInput() {
+#ifdef ROBOT_HAVE_MMAP
+        if (mapped_ != nullptr) {
+            munmap(const_cast<char *>(mapped_), size_);
+        }
+#endif
+    }
+
+    MappedInput(const MappedInput &) = delete;
+    MappedInput &operator=(const MappedInput &) = delete;
+
+    // 文件是否成功打开
+    bool Ok() const {
+        return mapped_ != nullptr || ok_;
+    }
+
+    const char *Begin() const {
+        return mapped_ != nullptr ? mapped_ : buffer_.data();
+    }
+
+    const char *End() const {
+        return Begin() + size_;
+    }
+
+private:
+    const char *mapped_ = nullptr;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+    bool ok_ = false;
+};
+
+// 并行解析[begin, end)中的全部指令，按顺序返回各段的指令数组，依次拼接后与CommandReader从begin开始逐条读取完全一致。
+// 输入在换行处切成至多threads段、每段不小于min_chunk_size字节，各线程用CommandReader解析自己的一段。
+// 切分点紧跟在换行之后，不会切断数字或指令字母，所以只要前面各段都恰好解析到段尾，下一段的起点就是串行解析到达的位置。
+// 某一段末尾有不完整的指令（指令跨行或遇到无法解析的内容）时，从该段起点开始改为串行解析剩余全部输入，作为最后一段。
+// 各段不再拼接成一个数组，调用方可以逐段处理并释放，峰值内存只有一份全部指令
+inline std::vector<std::vector<Command> > ParseCommandChunksParallel(const char *begin, const char *end,
+                                                                    unsigned threads,
+                                                                    size_t min_chunk_size = 1 << 16) {
+    size_t size = end - begin;
+    size_t max_chunks = size / std::max<size_t>(min_chunk_size, 1) + 1;
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, max_chunks)));
+    // 各段起点，最后一个元素为end
+    std::vector<const char *> bounds{begin};
+    for (unsigned i = 1; i < threads; i++) {
+        const char *target = std::max(begin + size / threads * i, bounds.back());
+        const void *newline = std::memchr(target, '\n', end - target);
+        bounds.push_back(newline != nullptr ? static_cast<const char *>(newline) + 1 : end);
+    }
+    bounds.push_back(end);
+
+    struct Chunk {
+        std::vector<Command> commands;
+        // 是否恰好解析到段尾
+        bool complete = false;
+    };
+    std::vector<Chunk> chunks(threads);
+    auto parse = [&](unsigned index) {
+        CommandReader reader(bounds[index], bounds[index + 1]);
+        Chunk &chunk = chunks[index];
+        // 按平均每行约16字节预留
+        chunk.commands.reserve((bounds[index + 1] - bounds[index]) / 16);
+        Command command{};
+        while (!reader.AtEnd()) {
+            if (!reader.ReadCommand(command)) return;
+            chunk.commands.push_back(command);
+        }
+        chunk.complete = true;
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back(parse, i);
+    }
+    parse(0);
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+
+    // 保留第一个不完整的段之前的各段，从该段起点串行解析其后的全部输入作为最后一段
+    std::vector<std::vector<Command> > result;
+    for (unsigned i = 0; i < threads; i++) {
+        if (!chunks[i].complete) {
+            // 丢弃其后各段的结果，先释放再串行解析
+            chunks.erase(chunks.begin() + i, chunks.end());
+            std::vector<Command> &rest = result.emplace_back();
+            CommandReader reader(bounds[i], end);
+            Command command{};
+            while (reader.ReadCommand(command)) {
+                rest.push_back(command);
+            }
+            break;
+        }
+        result.push_back(std::move(chunks[i].commands));
+    }
+    return result;
+}
+
+// 流水线处理：解析线程用reader读取至多count条指令放入容量为capacity的环形队列，
+// 调用线程依次取出交给handle，读取解析与处理同时进行；handle按输入顺序在调用线程中被调用
+template<typename Handler>
+void ParseCommandsPipelined(CommandReader &reader, uint32_t count, size_t capacity, Handler &&handle) {
+    SpscRing<Command> ring(capacity);
+    std::thread parser([&] {
+        Command command{};
+        for (uint32_t i = 0; i < count && reader.ReadCommand(command); i++) {
+            ring.Push(command);
+        }
+        ring.Close();
+    });
+    Command command{};
+    while (ring.Pop(command)) {
+        handle(command);
+    }
+    parser.join();
+}
+
+#endif //UNTITLED1_COMMAND_REPLAY_H
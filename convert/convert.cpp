@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "bench/workload.h"
+#include "binary_command.h"
+#include "command_reader.h"
+#include "command_replay.h"
+
+// 指令格式转换：文本格式（主程序的输入格式）与二进制格式互相转换，输入格式按文件开头自动判断。
+// 用法：robot_convert 输入文件 输出文件
+// 输入为文本时输出二进制，输入为二进制时输出文本；只转换指令数量范围内能完整读出的指令
+
+namespace {
+
+struct CommandFile {
+    uint32_t dense_teams = 0;
+    uint32_t dense_robots = 0;
+    std::vector<Command> commands;
+};
+
+bool ReadText(const char *begin, const char *end, CommandFile &file) {
+    CommandReader reader(begin, end);
+    uint32_t count;
+    if (!reader.ReadHeader(file.dense_teams, file.dense_robots, count)) return false;
+    Command command{};
+    for (uint32_t i = 0; i < count && reader.ReadCommand(command); i++) {
+        file.commands.push_back(command);
+    }
+    return true;
+}
+
+bool ReadBinary(const char *begin, const char *end, CommandFile &file) {
+    BinaryCommandReader reader(begin, end);
+    uint32_t count;
+    if (!reader.ReadHeader(file.dense_teams, file.dense_robots, count)) return false;
+    Command command{};
+    for (uint32_t i = 0; i < count && reader.ReadCommand(command); i++) {
+        file.commands.push_back(command);
+    }
+    return true;
+}
+
+void WriteText(std::ostream &out, const CommandFile &file) {
+    if (file.dense_teams != 0 || file.dense_robots != 0) {
+        out << "#dense " << file.dense_teams << ' ' << file.dense_robots << '\n';
+    }
+    WriteWorkload(out, file.commands);
+}
+
+void WriteBinary(std::ostream &out, const CommandFile &file) {
+    BinaryCommandWriter writer(out);
+    writer.WriteHeader(file.dense_teams, file.dense_robots, static_cast<uint32_t>(file.commands.size()));
+    for (const Command &command: file.commands) {
+        writer.Write(command);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s INPUT OUTPUT\n", argv[0]);
+        return 2;
+    }
+    MappedInput input(argv[1]);
+    if (!input.Ok()) {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    bool binary = IsBinaryCommands(input.Begin(), input.End());
+    CommandFile file;
+    if (!(binary ? ReadBinary(input.Begin(), input.End(), file) : ReadText(input.Begin(), input.End(), file))) {
+        std::fprintf(stderr, "cannot parse %s\n", argv[1]);
+        return 1;
+    }
+    std::ofstream out(argv[2], std::ios::binary);
+    if (!out) {
+        std::fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+    if (binary) {
+        WriteText(out, file);
+    } else {
+        WriteBinary(out, file);
+    }
+    std::fprintf(stderr, "%zu commands converted to %s\n", file.commands.size(), binary ? "text" : "binary");
+    return 0;
+}
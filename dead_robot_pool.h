@@ -0,0 +1,55 @@
+#ifndef UNTITLED1_DEAD_ROBOT_POOL_H
+#define UNTITLED1_DEAD_ROBOT_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "robot_index.h"
+#include "robot_key.h"
+#include "robot_type.h"
+
+// 击毁池：已击毁的机器人不再占用机器人对象和列式存储中的行，复活时Rebuild会恢复其余属性，
+// 只需保留双ID、类型和等级。同一双ID每种类型至多有一条记录（同类型的A指令会复活而不是新建），
+// 因此按双ID打包成的键建索引，每个双ID下按类型各记一个等级，查找和删除该双ID的全部记录都是O(1)
+class DeadRobotPool {
+public:
+    // 查找失败时返回的等级，有效等级从1开始
+    static constexpr uint32_t kNotFound = 0;
+
+    // 设置索引的稠密ID范围，见RobotIndex
+    void SetDenseRange(DenseIdRange range) {
+        robots_.SetDenseRange(range);
+    }
+
+    void Add(RobotKey key, RobotType type, uint32_t level) {
+        robots_[key].level[static_cast<size_t>(type)] = static_cast<uint8_t>(level);
+    }
+
+    // 找双ID和类型都匹配的记录，返回其等级；双ID匹配但类型不同也视为没找到，返回kNotFound
+    uint32_t Find(RobotKey key, RobotType type) const {
+        auto index = static_cast<size_t>(type);
+        if (index >= kTypeCount) return kNotFound;
+        const DeadRecord *record = robots_.Find(key);
+        if (record == nullptr) return kNotFound;
+        return record->level[index];
+    }
+
+    // 删除该双ID的所有记录
+    void RemoveId(RobotKey key) {
+        robots_.Erase(key);
+    }
+
+private:
+    static constexpr size_t kTypeCount = 2;
+
+    // 同一双ID下各类型的等级，kNotFound表示该类型没有记录；各类型都没有记录的DeadRecord{}即索引中的空格子
+    struct DeadRecord {
+        uint8_t level[kTypeCount];
+
+        bool operator==(const DeadRecord &) const = default;
+    };
+
+    RobotIndex<DeadRecord> robots_;
+};
+
+#endif //UNTITLED1_DEAD_ROBOT_POOL_H
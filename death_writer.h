@@ -0,0 +1,228 @@
+#ifndef UNTITLED1_DEATH_WRITER_H
+#define UNTITLED1_DEATH_WRITER_H
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "robot_key.h"
+#include "spsc_ring.h"
+
+// 击毁事件输出器：把"D 队伍ID 机器人ID"行格式化到缓冲区，而不是每行都刷新输出流。
+// 缓冲区写满、调用Flush或析构时写出；flush_each_batch为true时每次EndBatch也会写出。
+// 用Async创建时改为异步模式：Write只把键放入无锁队列，由专门的输出线程按放入顺序格式化并成批写出，
+// 调用线程只在队列满时等待；输出线程无事可做时阻塞等待唤醒，不占用CPU
+class DeathWriter {
+public:
+    explicit DeathWriter(std::ostream &out = std::cout, size_t buffer_size = 1 << 16, bool flush_each_batch = false)
+        : out_(&out), buffer_(std::max<size_t>(buffer_size, kMaxLineSize)), flush_each_batch_(flush_each_batch) {
+    }
+
+    // 移动后原对象不再持有输出流，析构时不会重复写出
+    DeathWriter(DeathWriter &&other) noexcept
+        : out_(std::exchange(other.out_, nullptr)), buffer_(std::move(other.buffer_)),
+          size_(std::exchange(other.size_, 0)), flush_each_batch_(other.flush_each_batch_),
+          async_(std::move(other.async_)), pushed_(std::exchange(other.pushed_, 0)) {
+    }
+
+    // 创建异步模式的输出器：队列最多缓存queue_capacity个击毁事件，输出线程每次写出至多buffer_size字节
+    static DeathWriter Async(std::ostream &out = std::cout, size_t queue_capacity = 1 << 16,
+                             size_t buffer_size = 1 << 16, bool flush_each_batch = false) {
+        DeathWriter writer(out, buffer_size, flush_each_batch);
+        writer.async_ = std::make_unique<AsyncState>(out, std::move(writer.buffer_), queue_capacity);
+        writer.out_ = nullptr;
+        return writer;
+    }
+
+    DeathWriter &operator=(DeathWriter &&other) noexcept {
+        if (this != &other) {
+            Flush();
+            out_ = std::exchange(other.out_, nullptr);
+            buffer_ = std::move(other.buffer_);
+            size_ = std::exchange(other.size_, 0);
+            flush_each_batch_ = other.flush_each_batch_;
+            async_ = std::move(other.async_);
+            pushed_ = std::exchange(other.pushed_, 0);
+        }
+        return *this;
+    }
+
+    ~DeathWriter() {
+        Flush();
+    }
+
+    // 记录一个被击毁的机器人
+    void Write(RobotKey key) {
+        if (async_) {
+            async_->queue.Push(key);
+            async_->Wake();
+            pushed_++;
+            return;
+        }
+        if (buffer_.size() - size_ < kMaxLineSize) {
+            Flush();
+        }
+        size_ = FormatLine(buffer_.data() + size_, key) - buffer_.data();
+    }
+
+    // 一批指令处理完毕；异步模式下只通知输出线程尽快写出，不等待
+    void EndBatch() {
+        if (!flush_each_batch_) return;
+        if (async_) {
+            async_->RequestFlush(pushed_);
+        } else {
+            Flush();
+        }
+    }
+
+    // 把缓冲区内容写出并刷新输出流；异步模式下等待此前记录的击毁事件全部写出
+    void Flush() {
+        if (async_) {
+            async_->RequestFlush(pushed_);
+            async_->WaitFlushed(pushed_);
+            return;
+        }
+        if (out_ == nullptr || size_ == 0) return;
+        out_->write(buffer_.data(), static_cast<std::streamsize>(size_));
+        out_->flush();
+        size_ = 0;
+    }
+
+private:
+    // 一行的最大长度："D " + 两个10位数 + 空格 + 换行
+    static constexpr size_t kMaxLineSize = 2 + 10 + 1 + 10 + 1;
+
+    // 在pos处写入一行，返回行尾之后的位置，调用者保证至少有kMaxLineSize字节空间
+    static char *FormatLine(char *pos, RobotKey key) {
+        *pos++ = 'D';
+        *pos++ = ' ';
+        pos = std::to_chars(pos, pos + 10, key.TeamId()).ptr;
+        *pos++ = ' ';
+        pos = std::to_chars(pos, pos + 10, key.RobotId()).ptr;
+        *pos++ = '\n';
+        return pos;
+    }
+
+    // 异步模式的状态：事件队列和输出线程。计数都是从创建起放入队列的事件总数，
+    // 调用线程发布希望写出到的计数，输出线程写出并刷新后发布已写出的计数
+    struct AsyncState {
+        AsyncState(std::ostream &out, std::vector<char> buffer, size_t queue_capacity)
+            : queue(queue_capacity), out(out), buffer(std::move(buffer)), thread([this] { Run(); }) {
+        }
+
+        ~AsyncState() {
+            stop.store(true, std::memory_order_release);
+            Wake();
+            thread.join();
+        }
+
+        void RequestFlush(uint64_t count) {
+            if (flush_target.load(std::memory_order_relaxed) < count) {
+                flush_target.store(count, std::memory_order_release);
+                Wake();
+            }
+        }
+
+        // 阻塞等待输出线程写出到count，每次发布已写出的计数都会唤醒这里
+        void WaitFlushed(uint64_t count) const {
+            uint64_t current;
+            while ((current = flushed.load(std::memory_order_acquire)) < count) {
+                flushed.wait(current, std::memory_order_acquire);
+            }
+        }
+
+        // 调用线程放入事件、发布写出请求或停止标记之后调用：输出线程已声明休眠时撤销声明并唤醒它。
+        // sleeping只用读改写操作修改，每次都读到上一次修改并与之同步：声明在这里之前时这里会唤醒，
+        // 在这里之后时输出线程声明后的检查能看到这里之前的写入，不会漏掉唤醒
+        void Wake() {
+            if (sleeping.exchange(false, std::memory_order_acq_rel)) {
+                sleeping.notify_one();
+            }
+        }
+
+        // 输出线程：取出事件格式化到缓冲区，缓冲区满时整块写出；
+        // 队列暂时取空且有未完成的写出请求时写出并刷新。无事可做时先声明休眠、再完整检查一遍，
+        // 仍然无事可做才阻塞，直到Wake把声明撤销
+        void Run() {
+            size_t size = 0;
+            uint64_t count = 0;
+            bool announced = false;
+            RobotKey key;
+            for (;;) {
+                // 先读停止标记再取：停止前放入的事件此时都已可见
+                bool stopping = stop.load(std::memory_order_acquire);
+                if (queue.TryPop(key)) {
+                    if (buffer.size() - size < kMaxLineSize) {
+                        out.write(buffer.data(), static_cast<std::streamsize>(size));
+                        size = 0;
+                    }
+                    size = FormatLine(buffer.data() + size, key) - buffer.data();
+                    count++;
+                    CancelSleep(announced);
+                    continue;
+                }
+                // 请求写出到的事件可能还没从队列中取到，取够之前继续取
+                uint64_t target = flush_target.load(std::memory_order_acquire);
+                if (stopping || (target > flushed.load(std::memory_order_relaxed) && count >= target)) {
+                    if (size != 0) {
+                        out.write(buffer.data(), static_cast<std::streamsize>(size));
+                        size = 0;
+                    }
+                    out.flush();
+                    flushed.store(count, std::memory_order_release);
+                    flushed.notify_all();
+                    if (stopping) return;
+                    CancelSleep(announced);
+                    continue;
+                }
+                if (target > flushed.load(std::memory_order_relaxed)) {
+                    CancelSleep(announced);
+                    continue;
+                }
+                if (!announced) {
+                    sleeping.exchange(true, std::memory_order_acq_rel);
+                    announced = true;
+                    continue;
+                }
+                sleeping.wait(true, std::memory_order_acquire);
+                announced = false;
+            }
+        }
+
+        // 声明休眠后又找到了事情做，撤销声明，调用线程不必再唤醒
+        void CancelSleep(bool &announced) {
+            if (announced) {
+                sleeping.exchange(false, std::memory_order_acq_rel);
+                announced = false;
+            }
+        }
+
+        SpscRing<RobotKey> queue;
+        std::ostream &out;
+        std::vector<char> buffer;
+        std::atomic<uint64_t> flush_target{0};
+        std::atomic<uint64_t> flushed{0};
+        std::atomic<bool> stop{false};
+        // 输出线程已声明休眠，由Wake撤销并唤醒
+        std::atomic<bool> sleeping{false};
+        // 最后初始化，线程启动时其余成员都已就绪
+        std::thread thread;
+    };
+
+    std::ostream *out_;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+    bool flush_each_batch_;
+    // 异步模式的状态，同步模式下为空
+    std::unique_ptr<AsyncState> async_;
+    // 异步模式下已放入队列的事件数，只由调用线程读写
+    uint64_t pushed_ = 0;
+};
+
+#endif //UNTITLED1_DEATH_WRITER_H
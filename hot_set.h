@@ -0,0 +1,88 @@
+#ifndef UNTITLED1_HOT_SET_H
+#define UNTITLED1_HOT_SET_H
+
+#include <cstdint>
+#include <vector>
+
+#include "robot_store.h"
+
+// 热量集合：记录RobotStore中热量大于0的行。热量为0的步兵在时间推进中热量、血量都不变，
+// 所以时间推进只需处理集合中的行，耗时与当前有热量的机器人数成正比。
+// 集合为连续数组，每行记下自己在数组中的下标，加入和移除都是O(1)
+class HotSet {
+public:
+    //加入一行，已在集合中则什么也不做
+    void Insert(uint32_t row) {
+        if (row >= pos_.size()) {
+            pos_.resize(row + 1, kNotHot);
+        }
+        if (pos_[row] != kNotHot) return;
+        pos_[row] = static_cast<uint32_t>(rows_.size());
+        rows_.push_back(row);
+    }
+
+    //移除一行，不在集合中则什么也不做
+    void Erase(uint32_t row) {
+        if (row >= pos_.size() || pos_[row] == kNotHot) return;
+        RemoveAt(pos_[row]);
+    }
+
+    //行号from的行被移到行号to，集合中记录的行号随之更新；调用方保证to不在集合中
+    void Move(uint32_t from, uint32_t to) {
+        if (from >= pos_.size() || pos_[from] == kNotHot) return;
+        uint32_t pos = pos_[from];
+        pos_[from] = kNotHot;
+        if (to >= pos_.size()) {
+            pos_.resize(to + 1, kNotHot);
+        }
+        pos_[to] = pos;
+        rows_[pos] = to;
+    }
+
+    uint32_t Size() const {
+        return static_cast<uint32_t>(rows_.size());
+    }
+
+    // 对集合中的行做一次时间推进：先降热量，热量仍超过上限的再扣血，血量由非0变为0的行追加到dying。
+    // 热量降为0的行移出集合；被击毁的行热量不为0，留给调用方击毁时移除
+    void Tick(RobotStore &store, uint32_t time_delta, std::vector<uint32_t> &dying) {
+        for (uint32_t pos = 0; pos < rows_.size();) {
+            uint32_t row = rows_[pos];
+            uint32_t &heat = store.heat[row];
+            heat = (heat > time_delta) ? (heat - time_delta) : 0;
+            if (heat > store.max_heat[row]) {
+                uint32_t &blood = store.blood[row];
+                uint32_t old_blood = blood;
+                blood = (old_blood > time_delta) ? (old_blood - time_delta) : 0;
+                if (old_blood != 0 && blood == 0) {
+                    dying.push_back(row);
+                }
+            }
+            //移除时由末尾元素填补空位，因此不前进下标
+            if (heat == 0) {
+                RemoveAt(pos);
+            } else {
+                pos++;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kNotHot = static_cast<uint32_t>(-1);
+    // 集合中的行
+    std::vector<uint32_t> rows_;
+    // 每一行在rows_中的下标，不在集合中为kNotHot
+    std::vector<uint32_t> pos_;
+
+    void RemoveAt(uint32_t pos) {
+        uint32_t last = rows_.back();
+        pos_[rows_[pos]] = kNotHot;
+        if (pos + 1 != rows_.size()) {
+            rows_[pos] = last;
+            pos_[last] = pos;
+        }
+        rows_.pop_back();
+    }
+};
+
+#endif //UNTITLED1_HOT_SET_H
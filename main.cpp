@@ -1,305 +1,242 @@
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
-#include <tuple>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
-// 枚举，设置机器人类型
-enum class RobotType {
-    kInfantry = 0,
-    kEngineer = 1
-};
-
-// 设置基类
-class BaseRobot {
-public:
-    // 父类构造函数，赋值两种机器人通用的属性（队伍ID、机器人ID、机器人类别）
-    BaseRobot(uint32_t team_id, uint32_t robot_id, RobotType type)
-        : team_id(team_id), robot_id(robot_id), type(type), blood_(0), heat_(0),
-          max_blood_(0), max_heat_(0), level_(1) {
-    }
-
-    // 虚析构函数，自动生成默认析构逻辑，防止从容器中移除时内存泄漏
-    virtual ~BaseRobot() = default;
+#include "binary_command.h"
+#include "command_reader.h"
+#include "command_replay.h"
+#include "match_runner.h"
+#include "robot_manager.h"
+
+//读取文本输入开头的ID范围声明和指令数量，声明了ID范围时范围内的ID直接寻址
+static bool ReadTextHeader(CommandReader &reader, RobotManager &robot_manager, uint32_t &N) {
+    DenseIdRange dense_ids;
+    if (!reader.ReadHeader(dense_ids.teams, dense_ids.robots, N)) return false;
+    robot_manager.SetDenseIds(dense_ids);
+    return true;
+}
 
-    // 获取队伍ID和机器人ID
-    std::tuple<uint32_t, uint32_t> GetId() const {
-        return {team_id, robot_id};
-    }
+//创建输出器：异步模式下击毁事件由单独的输出线程写出
+static DeathWriter MakeDeathWriter(bool async_output) {
+    return async_output ? DeathWriter::Async() : DeathWriter();
+}
 
-    // 判断机器人是否击毁
-    bool IsDead() const {
-        if (blood_ <= 0) {
-            return true;
-        }
-        return false;
+//回放二进制格式的输入：逐条解码后直接交给管理类处理，不经过文本解析
+static int ReplayBinary(const MappedInput &input, bool async_output) {
+    RobotManager robot_manager(TickMode::kScheduled, MakeDeathWriter(async_output));
+    BinaryCommandReader reader(input.Begin(), input.End());
+    DenseIdRange dense_ids;
+    uint32_t N;
+    if (!reader.ReadHeader(dense_ids.teams, dense_ids.robots, N)) return 0;
+    robot_manager.SetDenseIds(dense_ids);
+    Command command{};
+    for (uint32_t i = 0; i < N && reader.ReadCommand(command); i++) {
+        robot_manager.HandleCommand(command);
     }
+    robot_manager.FlushOutput();
+    return 0;
+}
 
-    // 随时间改变热量降低，超热量扣血
-    void ChangeHeat(uint32_t time_delta) {
-        // 判断热量改变后是否小于0,若小于0则直接将热量置0
-        heat_ = (heat_ > time_delta) ? (heat_ - time_delta) : 0;
-        // 当热量大于热量极限时，减少血量，判断血量减少后是否小于0,若小于0则置0
-        if (heat_ > max_heat_) {
-            blood_ = (blood_ > time_delta) ? (blood_ - time_delta) : 0;
+//回放模式：整体载入输入文件，多线程解析出全部指令后再在单线程中按顺序处理，输出与逐条读取完全一致；
+//解析结果按段处理，每段处理完立即释放。
+//文件为二进制格式时改为逐条解码处理
+static int Replay(const char *path, unsigned threads, bool async_output) {
+    MappedInput input(path);
+    if (!input.Ok()) {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    if (IsBinaryCommands(input.Begin(), input.End())) {
+        return ReplayBinary(input, async_output);
+    }
+    RobotManager robot_manager(TickMode::kScheduled, MakeDeathWriter(async_output));
+    //开头的ID范围声明和指令数量串行读取，其余部分并行解析
+    CommandReader header(input.Begin(), input.End());
+    uint32_t N;
+    if (!ReadTextHeader(header, robot_manager, N)) return 0;
+    std::vector<std::vector<Command> > chunks = ParseCommandChunksParallel(header.Position(), input.End(), threads);
+    uint32_t remaining = N;
+    for (std::vector<Command> &chunk: chunks) {
+        size_t count = std::min<size_t>(chunk.size(), remaining);
+        for (size_t i = 0; i < count; i++) {
+            robot_manager.HandleCommand(chunk[i]);
         }
+        remaining -= static_cast<uint32_t>(count);
+        std::vector<Command>().swap(chunk);
     }
+    robot_manager.FlushOutput();
+    return 0;
+}
 
-    // 纯虚函数，使子类在不同状况下改变机器人属性
-    virtual void Rebuild() =0;
-
-    // 纯虚函数，使管理类可识别机器人类型
-    virtual RobotType GetType() const = 0;
-
-protected:
-    // 机器人的所有属性，子类可访问，外部不可
-    uint32_t team_id, robot_id, heat_, max_heat_, level_, max_blood_;
-    RobotType type;
-
-public:
-    uint32_t blood_;
-};
+//流水线模式：解析线程从标准输入读取指令放入容量为capacity的环形队列，主线程依次取出处理，
+//读取解析与处理同时进行；处理仍按输入顺序在单线程中进行，输出与逐条读取完全一致
+static int Pipeline(size_t capacity, bool async_output) {
+    RobotManager robot_manager(TickMode::kScheduled, MakeDeathWriter(async_output));
+    CommandReader reader(stdin);
+    uint32_t N;
+    if (!ReadTextHeader(reader, robot_manager, N)) return 0;
+    ParseCommandsPipelined(reader, N, capacity, [&](const Command &command) {
+        robot_manager.HandleCommand(command);
+    });
+    robot_manager.FlushOutput();
+    return 0;
+}
 
-// 子类——步兵
-class InfantryRobot : public BaseRobot {
-public:
-    InfantryRobot(uint32_t team_id, uint32_t robot_id) : BaseRobot(team_id, robot_id, RobotType::kInfantry) {
-        level_ = 1;
-        Rebuild();
-    }
+//在系统临时目录下新建一个名字随机的目录，只用标准库，不依赖平台接口
+static bool CreateTempDirectory(std::filesystem::path &dir) {
+    std::error_code error;
+    std::filesystem::path base = std::filesystem::temp_directory_path(error);
+    if (error) return false;
+    std::mt19937_64 rng(std::random_device{}());
+    for (int attempt = 0; attempt < 100; attempt++) {
+        dir = base / ("untitled1-matches-" + std::to_string(rng()));
+        if (std::filesystem::create_directory(dir, error)) return true;
+        if (error) return false;
+    }
+    return false;
+}
 
-    // 步兵纯虚函数，根据等级不同机器人的属性赋值不同
-    void Rebuild() override {
-        heat_ = 0;
-        // 根据等级赋值
-        switch (level_) {
-            case 1: {
-                max_blood_ = 100;
-                max_heat_ = 100;
-                break;
-            }
-            case 2: {
-                max_blood_ = 150;
-                max_heat_ = 200;
-                break;
-            }
-            case 3: {
-                max_blood_ = 250;
-                max_heat_ = 300;
-                break;
-            }
-            default: {
-                max_blood_ = 100;
-                max_heat_ = 100;
+//多场比赛模式：每个输入文件是一场比赛（目录展开为其中的全部普通文件），比赛ID为去掉扩展名的文件名，不能重复；
+//文件可以是文本或二进制格式。各场比赛在工作窃取线程池上并行处理，每场比赛内部仍按输入顺序处理，
+//输入在比赛开始时才载入，击毁事件直接写到这场比赛的输出文件。
+//给出输出目录时输出文件为"目录/比赛ID.out"；否则先写到临时目录，全部结束后按比赛ID顺序写到标准输出，
+//每场之前有一行"# match 比赛ID"
+static int RunMatches(const std::vector<std::string> &paths, unsigned threads, const char *out_dir,
+                      bool async_output) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    for (const std::string &path: paths) {
+        std::error_code error;
+        if (!fs::is_directory(path, error)) {
+            files.emplace_back(path);
+            continue;
+        }
+        for (const fs::directory_entry &entry: fs::directory_iterator(path, error)) {
+            if (entry.is_regular_file(error)) {
+                files.push_back(entry.path());
             }
         }
-        blood_ = max_blood_;
     }
-
-    // 步兵升级
-    bool Upgrade(uint32_t target_level) {
-        if (target_level > level_ && target_level <= 3) {
-            level_ = target_level;
-            Rebuild();
-            return true;
+    std::sort(files.begin(), files.end(), [](const fs::path &a, const fs::path &b) {
+        return a.stem() != b.stem() ? a.stem() < b.stem() : a < b;
+    });
+    for (size_t i = 1; i < files.size(); i++) {
+        if (files[i].stem() == files[i - 1].stem()) {
+            std::fprintf(stderr, "duplicate match id %s: %s and %s\n", files[i].stem().string().c_str(),
+                         files[i - 1].string().c_str(), files[i].string().c_str());
+            return 2;
         }
-        return false;
-    }
-
-    // 返回机器人类型
-    RobotType GetType() const override {
-        return RobotType::kInfantry;
-    }
-
-    // 步兵独有，热量增加
-    void AddHeat(uint32_t add_heat) {
-        heat_ += add_heat;
-    }
-};
-
-// 子类——工程
-class EngineerRobot : public BaseRobot {
-public:
-    EngineerRobot(uint32_t team_id, uint32_t robot_id) : BaseRobot(team_id, robot_id, RobotType::kEngineer) {
-        Rebuild();
-    }
-
-    // 返回机器人类型
-    RobotType GetType() const override {
-        return RobotType::kEngineer;
     }
 
-    // 工程纯虚函数，无热量，血量上限300
-    void Rebuild() override {
-        max_blood_ = 300;
-        blood_ = max_blood_;
-        heat_ = 0;
-        max_heat_ = 0;
-    }
-};
-
-//机器人管理类
-class RobotManager {
-private:
-    //创建一个储存存活机器人的容器
-    std::vector<std::shared_ptr<BaseRobot> > live_robots_;
-    //创建一个储存已死亡机器人的容器
-    std::vector<std::shared_ptr<BaseRobot> > dead_robots_;
-    //初始化时间
-    uint32_t last_time_ = 0;
-
-public:
-    //在活机器人容器中找机器人
-    std::shared_ptr<BaseRobot> FindLiveRobot(uint32_t team_id, uint32_t robot_id) {
-        //运用迭代器找双ID匹配的机器人
-        auto it = find_if(live_robots_.begin(), live_robots_.end(), [&](const std::shared_ptr<BaseRobot> &robot) {
-            return robot->GetId() == std::make_tuple(team_id, robot_id);
-        });
-        if (it != live_robots_.end()) {
-            return *it;
+    fs::path output_dir;
+    if (out_dir != nullptr) {
+        output_dir = out_dir;
+    } else {
+        if (!CreateTempDirectory(output_dir)) {
+            std::fprintf(stderr, "cannot create a temporary directory\n");
+            return 1;
         }
-        return nullptr;
     }
-
-    //在已击毁的容器中找机器人
-    std::shared_ptr<BaseRobot> FindDeadRobot(uint32_t team_id, uint32_t robot_id, RobotType type) {
-        //运用迭代器找双ID匹配的机器人
-        auto it = find_if(dead_robots_.begin(), dead_robots_.end(), [&](const std::shared_ptr<BaseRobot> &robot) {
-            return robot->GetId() == std::make_tuple(team_id, robot_id) && robot->GetType() == type;
-        });
-        if (it != dead_robots_.end()) {
-            return *it;
-        }
-        return nullptr;
+    MatchRunner runner(threads, 4096, 0, async_output);
+    for (const fs::path &file: files) {
+        std::string id = file.stem().string();
+        runner.AddMatchFiles(id, file.string(), (output_dir / (id + ".out")).string());
     }
-
-    //处理时间变化函数
-    void HandleTimeChange(uint32_t curr_time) {
-        //如果时间不变，各参数不变，直接返回
-        if (curr_time <= last_time_) return;
-        uint32_t time_delta = curr_time - last_time_;
-        //运用迭代器遍历活机器人，改变其参数
-        for (auto it = live_robots_.begin(); it != live_robots_.end();) {
-            (*it)->ChangeHeat(time_delta);
-            //判断参数改变后是否死亡，若死亡则移到击毁池，并按格式输出
-            if ((*it)->IsDead()) {
-                dead_robots_.push_back(*it);
-                auto [team_id,robot_id] = (*it)->GetId();
-                std::cout << "D" << " " << team_id << " " << robot_id << std::endl;
-                it = live_robots_.erase(it);
-            } else {
-                it++;
-            }
-        }
-        last_time_ = curr_time;
+    bool ok = runner.Run();
+    for (const std::string &error: runner.Errors()) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+    }
+    if (out_dir != nullptr) {
+        return ok ? 0 : 1;
     }
 
-    //处理指令A，添加或复活机器人
-    void HandleCommandA(uint32_t team_id, uint32_t robot_id, RobotType type) {
-        //若机器人已存在且未死亡则指令无效返回
-        if (FindLiveRobot(team_id, robot_id) != nullptr) return;
-        //查找机器人是否在击毁池中，若在则复活
-        auto robot = FindDeadRobot(team_id, robot_id, type);
-        if (robot != nullptr) {
-            robot->Rebuild();
-            live_robots_.push_back(robot);
-            //在击毁池中删除该机器人
-            for (auto it = dead_robots_.begin(); it != dead_robots_.end();) {
-                if ((*it)->GetId() == std::make_tuple(team_id, robot_id)) {
-                    it = dead_robots_.erase(it);
-                } else {
-                    it++;
-                }
+    for (const fs::path &file: files) {
+        std::string id = file.stem().string();
+        fs::path out_path = output_dir / (id + ".out");
+        std::ifstream in(out_path, std::ios::binary);
+        if (in) {
+            std::cout << "# match " << id << '\n';
+            if (in.peek() != std::ifstream::traits_type::eof()) {
+                std::cout << in.rdbuf();
             }
-            return;
         }
+        in.close();
+        std::error_code error;
+        fs::remove(out_path, error);
+    }
+    std::error_code error;
+    fs::remove(output_dir, error);
+    std::cout.flush();
+    return ok ? 0 : 1;
+}
 
-        //若不在击毁池中，则按类别新建该机器人
-        if (type == RobotType::kInfantry) {
-            live_robots_.push_back(std::make_shared<InfantryRobot>(team_id, robot_id));
-        } else if (type == RobotType::kEngineer) {
-            live_robots_.push_back(std::make_shared<EngineerRobot>(team_id, robot_id));
+//主函数部分
+//用法：untitled1                             从标准输入逐条读取并处理
+//      untitled1 --replay=文件 [--threads=N]  回放模式，文件可以是文本或二进制格式，默认线程数为CPU核数
+//      untitled1 --pipeline[=容量]            流水线模式，从标准输入读取，队列默认容量4096条指令
+//      untitled1 --matches=路径 [--matches=路径 ...] [--threads=N] [--out-dir=目录]
+//                                              多场比赛模式，路径可以是文件或目录，默认线程数为CPU核数
+//      以上各模式均可加 --async-output        击毁事件由单独的输出线程写出，多场比赛模式下每场比赛各一个
+int main(int argc, char **argv) {
+    const char *replay_path = nullptr;
+    std::vector<std::string> match_paths;
+    const char *out_dir = nullptr;
+    bool async_output = false;
+    unsigned threads = std::thread::hardware_concurrency();
+    size_t pipeline_capacity = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--replay=", 9) == 0) {
+            replay_path = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = static_cast<unsigned>(std::strtoul(argv[i] + 10, nullptr, 10));
+        } else if (std::strcmp(argv[i], "--pipeline") == 0) {
+            pipeline_capacity = 4096;
+        } else if (std::strncmp(argv[i], "--pipeline=", 11) == 0) {
+            pipeline_capacity = std::max<size_t>(1, std::strtoul(argv[i] + 11, nullptr, 10));
+        } else if (std::strcmp(argv[i], "--async-output") == 0) {
+            async_output = true;
+        } else if (std::strncmp(argv[i], "--matches=", 10) == 0) {
+            match_paths.emplace_back(argv[i] + 10);
+        } else if (std::strncmp(argv[i], "--out-dir=", 10) == 0) {
+            out_dir = argv[i] + 10;
+        } else {
+            std::fprintf(stderr, "usage: %s [--replay=FILE [--threads=N] | --pipeline[=CAPACITY]] [--async-output]\n"
+                                 "       %s --matches=PATH... [--threads=N] [--out-dir=DIR] [--async-output]\n", argv[0], argv[0]);
+            return 2;
         }
     }
-
-    //处理F指令，机器人扣血指令
-    void HandleCommandF(uint32_t team_id, uint32_t robot_id, uint32_t damage) {
-        //在存活机器人中找该机器人
-        auto robot = FindLiveRobot(team_id, robot_id);
-        //如果没找到或者已击毁，则指令无效返回
-        if (robot == nullptr || robot->IsDead()) return;
-        //更新血量，如果掉血量高于现有血量直接归零
-        uint32_t new_blood = robot->blood_ > damage ? (robot->blood_ - damage) : 0;
-        robot->blood_ = new_blood;
-        //判断机器人掉血后是否被击毁，如被击毁则移到击毁池，并按规定输出
-        if (robot->IsDead()) {
-            dead_robots_.push_back(robot);
-            auto [team_id,robot_id] = robot->GetId();
-            std::cout << "D" << " " << team_id << " " << robot_id << std::endl;
-            //在存活池中找到目标机器人并移除
-            for (auto it = live_robots_.begin(); it != live_robots_.end();) {
-                if ((*it)->GetId() == std::make_tuple(team_id, robot_id)) {
-                    it = live_robots_.erase(it);
-                } else {
-                    it++;
-                }
-            }
-        }
+    if (!match_paths.empty()) {
+        return RunMatches(match_paths, threads, out_dir, async_output);
     }
-
-    //处理H指令，只针对步兵子类，增加热量
-    void HandleCommandH(uint32_t team_id, uint32_t robot_id, uint32_t add_heat) {
-        //在存活池中找到目标机器人
-        auto robot = FindLiveRobot(team_id, robot_id);
-        //没找到或其类型为工程则指令无效直接返回
-        if (robot == nullptr || robot->GetType() == RobotType::kEngineer) return;
-        //将机器人从父类转到步兵子类，以调用步兵子类中特有的加热量函数
-        auto infantry = dynamic_pointer_cast<InfantryRobot>(robot);
-        if (infantry != nullptr) {
-            infantry->AddHeat(add_heat);
-        }
+    if (replay_path != nullptr) {
+        return Replay(replay_path, threads, async_output);
     }
-
-    //处理指令U，只针对步兵子类，对机器人升级
-    void HandCommandU(uint32_t team_id, uint32_t robot_id, uint32_t target_level) {
-        //在存活池中找到目标机器人
-        auto robot = FindLiveRobot(team_id, robot_id);
-        //没找到或其类型为工程则指令无效直接返回
-        if (robot == nullptr || robot->GetType() == RobotType::kEngineer) return;
-        //将机器人从父类转到步兵子类，以调用步兵子类中特有的升级函数
-        auto infantry = dynamic_pointer_cast<InfantryRobot>(robot);
-        if (infantry != nullptr) {
-            infantry->Upgrade(target_level);
-        }
+    if (pipeline_capacity != 0) {
+        return Pipeline(pipeline_capacity, async_output);
     }
-};
 
-//主函数部分
-int main() {
     //实例化管理类
-    RobotManager robot_manager;
+    RobotManager robot_manager(TickMode::kScheduled, MakeDeathWriter(async_output));
+    //输入读取器
+    CommandReader reader(stdin);
     //获取输入指令数量
     uint32_t N;
-    std::cin >> N;
+    if (!ReadTextHeader(reader, robot_manager, N)) return 0;
     //分别处理每一条输入的指令
-    for (uint32_t i = 0; i < N; i++) {
-        //获取指令内容
-        uint32_t time;
-        std::string cmd;
-        uint32_t p1, p2, p3;
-        std::cin >> time >> cmd >> p1 >> p2 >> p3;
-        //调用管理类的时间变化处理函数
-        robot_manager.HandleTimeChange(time);
-        //按不同cmd类型分别调用其管理类中对应的处理函数
-        if (cmd == "A") {
-            robot_manager.HandleCommandA(p1, p2, static_cast<RobotType>(p3));
-        } else if (cmd == "F") {
-            robot_manager.HandleCommandF(p1, p2, p3);
-        } else if (cmd == "H") {
-            robot_manager.HandleCommandH(p1, p2, p3);
-        } else if (cmd == "U") {
-            robot_manager.HandCommandU(p1, p2, p3);
-        }
+    Command command{};
+    for (uint32_t i = 0; i < N && reader.ReadCommand(command); i++) {
+        robot_manager.HandleCommand(command);
     }
+    //输入结束，写出剩余的击毁事件
+    robot_manager.FlushOutput();
     return 0;
 }
@@ -0,0 +1,206 @@
+#ifndef UNTITLED1_MATCH_RUNNER_H
+#define UNTITLED1_MATCH_RUNNER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binary_command.h"
+#include "command_reader.h"
+#include "command_replay.h"
+#include "robot_manager.h"
+#include "work_stealing_pool.h"
+
+// 多场比赛的运行器：每场比赛有自己的指令流（文本或二进制格式）、管理类和输出流，
+// 各场比赛的指令在工作窃取线程池上处理。每场比赛的指令切成每段chunk_size条的任务，
+// 一段处理完才放入下一段，所以同一场比赛同一时刻只有一个任务，指令按输入顺序处理，输出与单独处理这场比赛完全一致；
+// 不同比赛之间互不共享数据，吞吐量随线程数增长。
+// 同时进行的比赛数限制为max_active场，一场结束后才开始下一场；用AddMatchFiles添加的比赛在开始时才载入输入、
+// 打开输出文件，结束时关闭，内存占用和打开的文件数都不随比赛总数增长。
+// 每段指令处理完是一批，这一批的击毁事件随即写出（DeathWriter的flush_each_batch），比赛进行中输出文件就能看到进度；
+// async_output为true时每场比赛的击毁事件由各自的输出线程写出，见DeathWriter::Async
+class MatchRunner {
+public:
+    explicit MatchRunner(unsigned threads, size_t chunk_size = 4096, size_t max_active = 0, bool async_output = false)
+        : pool_(threads), chunk_size_(std::max<size_t>(chunk_size, 1)),
+          max_active_(max_active != 0 ? max_active : 4 * pool_.ThreadCount()), async_output_(async_output) {
+    }
+
+    // 添加一场比赛：指令流在[begin, end)中，击毁事件写到out；两者都由调用方保证在Run返回前有效，
+    // 且每场比赛的输出流互不相同
+    void AddMatch(std::string id, const char *begin, const char *end, std::ostream &out) {
+        auto match = std::make_unique<Match>();
+        match->id = std::move(id);
+        match->begin = begin;
+        match->end = end;
+        match->out = &out;
+        matches_.push_back(std::move(match));
+    }
+
+    // 添加一场比赛：比赛开始时载入input_path（文本或二进制格式），击毁事件写到output_path，比赛结束时关闭
+    void AddMatchFiles(std::string id, std::string input_path, std::string output_path) {
+        auto match = std::make_unique<Match>();
+        match->id = std::move(id);
+        match->input_path = std::move(input_path);
+        match->output_path = std::move(output_path);
+        matches_.push_back(std::move(match));
+    }
+
+    // 处理全部比赛，全部结束后返回；有比赛的文件无法打开或写入时返回false，原因见Errors
+    bool Run() {
+        next_match_.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < max_active_; i++) {
+            StartNextMatch();
+        }
+        pool_.Wait();
+        return Errors().empty();
+    }
+
+    // 各场比赛的文件错误，按添加顺序
+    std::vector<std::string> Errors() const {
+        std::vector<std::string> errors;
+        for (const auto &match: matches_) {
+            if (!match->error.empty()) {
+                errors.push_back(match->id + ": " + match->error);
+            }
+        }
+        return errors;
+    }
+
+    // 已处理的指令总数
+    uint64_t CommandCount() const {
+        uint64_t total = 0;
+        for (const auto &match: matches_) {
+            total += match->processed;
+        }
+        return total;
+    }
+
+private:
+    struct Match {
+        std::string id;
+        // 输入输出为文件时的路径，为空表示由调用方给出
+        std::string input_path;
+        std::string output_path;
+        const char *begin = nullptr;
+        const char *end = nullptr;
+        std::ostream *out = nullptr;
+        std::string error;
+        // 以下只在比赛进行中存在
+        std::optional<MappedInput> input;
+        std::optional<std::ofstream> file;
+        std::unique_ptr<RobotManager> manager;
+        std::optional<CommandReader> text;
+        std::optional<BinaryCommandReader> binary;
+        uint32_t remaining = 0;
+        uint64_t processed = 0;
+    };
+
+    // 每场比赛输出器的队列容量和缓冲区大小，与DeathWriter的默认值一致
+    static constexpr size_t kQueueCapacity = 1 << 16;
+    static constexpr size_t kBufferSize = 1 << 16;
+
+    WorkStealingPool pool_;
+    size_t chunk_size_;
+    size_t max_active_;
+    bool async_output_;
+    std::vector<std::unique_ptr<Match> > matches_;
+    std::atomic<size_t> next_match_{0};
+
+    // 取出下一场尚未开始的比赛，打开它的文件、读取开头的声明后放入第一段任务；
+    // 文件无法打开时记下原因，改为开始再下一场
+    void StartNextMatch() {
+        Match *match;
+        do {
+            size_t index = next_match_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= matches_.size()) return;
+            match = matches_[index].get();
+        } while (!OpenFiles(*match));
+        DeathWriter writer = async_output_ ? DeathWriter::Async(*match->out, kQueueCapacity, kBufferSize, true)
+                                           : DeathWriter(*match->out, kBufferSize, true);
+        match->manager = std::make_unique<RobotManager>(TickMode::kScheduled, std::move(writer));
+        DenseIdRange dense_ids;
+        bool ok;
+        if (IsBinaryCommands(match->begin, match->end)) {
+            ok = match->binary.emplace(match->begin, match->end)
+                    .ReadHeader(dense_ids.teams, dense_ids.robots, match->remaining);
+        } else {
+            ok = match->text.emplace(match->begin, match->end)
+                    .ReadHeader(dense_ids.teams, dense_ids.robots, match->remaining);
+        }
+        if (!ok) {
+            match->remaining = 0;
+            dense_ids = DenseIdRange{};
+        }
+        match->manager->SetDenseIds(dense_ids);
+        pool_.Submit([this, match] { RunChunk(match); });
+    }
+
+    // 处理一场比赛的下一段指令；比赛未结束时放入下一段任务，结束时写出剩余输出并开始下一场比赛
+    void RunChunk(Match *match) {
+        Command command{};
+        for (size_t i = 0; i < chunk_size_ && match->remaining != 0; i++) {
+            bool ok = match->binary ? match->binary->ReadCommand(command) : match->text->ReadCommand(command);
+            if (!ok) {
+                match->remaining = 0;
+                break;
+            }
+            match->manager->HandleCommand(command);
+            match->remaining--;
+            match->processed++;
+        }
+        if (match->remaining != 0) {
+            match->manager->EndBatch();
+            pool_.Submit([this, match] { RunChunk(match); });
+            return;
+        }
+        match->manager->FlushOutput();
+        match->manager.reset();
+        match->text.reset();
+        match->binary.reset();
+        match->input.reset();
+        if (match->file) {
+            match->file->close();
+            if (!*match->file) {
+                match->error = "cannot write " + match->output_path;
+            }
+            match->file.reset();
+        }
+        StartNextMatch();
+    }
+
+    // 载入文件形式的输入、打开输出文件，失败时记下原因并返回false
+    static bool OpenFiles(Match &match) {
+        if (!match.input_path.empty()) {
+            MappedInput &input = match.input.emplace(match.input_path.c_str());
+            if (!input.Ok()) {
+                match.error = "cannot open " + match.input_path;
+                match.input.reset();
+                return false;
+            }
+            match.begin = input.Begin();
+            match.end = input.End();
+        }
+        if (!match.output_path.empty()) {
+            std::ofstream &file = match.file.emplace(match.output_path, std::ios::binary);
+            if (!file) {
+                match.error = "cannot write " + match.output_path;
+                match.file.reset();
+                match.input.reset();
+                return false;
+            }
+            match.out = &file;
+        }
+        return true;
+    }
+};
+
+#endif //UNTITLED1_MATCH_RUNNER_H
@@ -0,0 +1,481 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench/workload.h"
+#include "binary_command.h"
+#include "command_reader.h"
+#include "command_replay.h"
+#include "match_runner.h"
+#include "reference_robot_manager.h"
+#include "robot_manager.h"
+
+// 差分测试：把同一条指令流分别交给冻结的参考实现和每一种优化引擎，
+// 每条指令处理完后比较新增的输出，报告第一条输出不一致的指令。
+// 另外比较并行解析与逐条读取得到的指令数组，检查二进制格式编码后能原样解码、经流水线处理的输出与参考实现一致，
+// 并把全部指令流作为多场比赛同时交给多场比赛运行器，每场的输出须与参考实现单独处理时一致。
+// 开始前还检查哈希索引模式下反复击毁、复活同一批机器人时不分配内存（全局operator new计数）。
+// 用法：robot_oracle [--trials=N] [--commands=N] [--seed=N] [--save=PATH] [输入文件...]
+// 给出输入文件时回放这些文件，否则生成随机指令流；--save把第一个出错的指令流按输入格式写到PATH
+
+namespace {
+
+// 全局operator new的调用次数
+std::atomic<uint64_t> g_allocations{0};
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size != 0 ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+// 与上面的operator new配对；不内联，避免GCC把内联后的free误报为与new不匹配
+[[gnu::noinline]] void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+// 参与比较的优化引擎
+struct EngineConfig {
+    const char *name;
+    TickMode mode;
+    DenseIdRange dense_ids;
+    // 异步输出的队列容量，0表示同步输出
+    size_t async_queue = 0;
+    // 为true时每条指令后调用EndBatch而不是FlushOutput：同步输出随即写出，可以立即比较；
+    // 异步输出只发出写出请求、不等待，整条指令流处理完再Flush并比较全部输出
+    bool flush_each_batch = false;
+};
+
+// 稠密ID范围故意比随机指令流的ID范围小，同时覆盖直接寻址和退回哈希索引两种情况；
+// 异步输出的队列和缓冲区故意取得很小，让队列满和缓冲区满时的分批写出都被经常触发
+const EngineConfig kEngines[] = {
+    {"scan", TickMode::kScan, {}},
+    {"scheduled", TickMode::kScheduled, {}},
+    {"hot-set", TickMode::kHotSet, {}},
+    {"scheduled-dense", TickMode::kScheduled, {2, 8}},
+    {"scheduled-async", TickMode::kScheduled, {}, 4},
+    {"scheduled-batch", TickMode::kScheduled, {}, 0, true},
+    {"scheduled-async-batch", TickMode::kScheduled, {}, 4, true},
+};
+
+// 按引擎配置创建输出器
+DeathWriter MakeWriter(const EngineConfig &engine, std::ostream &out) {
+    if (engine.async_queue != 0) {
+        return DeathWriter::Async(out, engine.async_queue, 64, engine.flush_each_batch);
+    }
+    return DeathWriter(out, 1 << 16, engine.flush_each_batch);
+}
+
+struct OracleOptions {
+    uint64_t seed = 1;
+    uint32_t trials = 200;
+    uint32_t commands = 2000;
+    std::string save_path;
+    std::vector<std::string> files;
+};
+
+bool ParseArgs(int argc, char **argv, OracleOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            options.files.push_back(arg);
+            continue;
+        }
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = arg.substr(2, eq - 2);
+        const char *value = argv[i] + eq + 1;
+        if (name == "seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (name == "trials") {
+            options.trials = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (name == "commands") {
+            options.commands = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (name == "save") {
+            options.save_path = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 随机指令流：ID范围很小以便频繁命中同一机器人，并覆盖时间不变或倒退、无效指令和类型、
+// 接近uint32上限的热量和伤害、复活时类型不符等边界情况
+std::vector<Command> GenerateFuzzCommands(uint64_t seed, uint32_t count) {
+    SplitMix64 rng(seed);
+    uint32_t teams = 1 + rng.Uniform(3);
+    uint32_t ids = (rng.Uniform(3) == 0) ? 10 + rng.Uniform(30) : 1 + rng.Uniform(6);
+    // 各类指令的权重：A、F、H、U、无效
+    uint32_t weights[5] = {20 + rng.Uniform(30), 5 + rng.Uniform(30), 20 + rng.Uniform(30), 5 + rng.Uniform(10), 2};
+    uint32_t weight_sum = 0;
+    for (uint32_t weight: weights) weight_sum += weight;
+
+    static const uint32_t kDamages[] = {0, 1, 5, 20, 50, 100, 200, 300, 4294967295u};
+    static const uint32_t kHeats[] = {0, 1, 10, 50, 100, 150, 250, 400, 1000, 4294967200u, 4294967295u};
+    static const uint32_t kSteps[] = {0, 0, 1, 1, 2, 3, 5, 10, 50};
+
+    std::vector<Command> commands;
+    commands.reserve(count);
+    uint32_t time = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t roll = rng.Uniform(100);
+        if (roll < 60) {
+            time += kSteps[rng.Uniform(std::size(kSteps))];
+        } else if (roll < 70) {
+            time -= std::min(time, rng.Uniform(6));
+        } else if (roll < 72) {
+            time += 100 + rng.Uniform(300);
+        }
+        Command command{time, 0, rng.Uniform(teams + 1), rng.Uniform(ids + 1), 0};
+        uint32_t pick = rng.Uniform(weight_sum);
+        if (pick < weights[0]) {
+            command.cmd = 'A';
+            command.p3 = rng.Uniform(20) == 0 ? 2 : rng.Uniform(2);
+        } else if ((pick -= weights[0]) < weights[1]) {
+            command.cmd = 'F';
+            command.p3 = kDamages[rng.Uniform(std::size(kDamages))];
+        } else if ((pick -= weights[1]) < weights[2]) {
+            command.cmd = 'H';
+            command.p3 = kHeats[rng.Uniform(std::size(kHeats))];
+        } else if ((pick -= weights[2]) < weights[3]) {
+            command.cmd = 'U';
+            command.p3 = rng.Uniform(5);
+        } else {
+            command.p3 = rng.Uniform(10);
+        }
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+std::vector<Command> LoadCommands(const std::string &path) {
+    std::vector<Command> commands;
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        return commands;
+    }
+    {
+        CommandReader reader(file);
+        uint32_t teams, robots, count;
+        Command command{};
+        if (reader.ReadHeader(teams, robots, count)) {
+            for (uint32_t i = 0; i < count && reader.ReadCommand(command); i++) {
+                commands.push_back(command);
+            }
+        }
+    }
+    std::fclose(file);
+    return commands;
+}
+
+bool SameCommand(const Command &a, const Command &b) {
+    return a.time == b.time && a.cmd == b.cmd && a.p1 == b.p1 && a.p2 == b.p2 && a.p3 == b.p3;
+}
+
+// 用不同的线程数和很小的分段把text并行解析，结果须与逐条读取一致
+bool CheckParallelParse(const std::string &label, const std::string &text) {
+    const char *begin = text.data();
+    const char *end = begin + text.size();
+    std::vector<Command> expected;
+    CommandReader reader(begin, end);
+    Command command{};
+    while (reader.ReadCommand(command)) {
+        expected.push_back(command);
+    }
+    for (unsigned threads: {2u, 3u, 8u}) {
+        std::vector<Command> actual;
+        for (const std::vector<Command> &chunk: ParseCommandChunksParallel(begin, end, threads, 64)) {
+            actual.insert(actual.end(), chunk.begin(), chunk.end());
+        }
+        bool same = actual.size() == expected.size() &&
+                    std::equal(actual.begin(), actual.end(), expected.begin(), SameCommand);
+        if (!same) {
+            std::printf("PARSE DIVERGED %s threads=%u: %zu commands, expected %zu\n", label.c_str(), threads,
+                        actual.size(), expected.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+// 编码成二进制格式再解码，结果须与原指令流一致
+bool CheckBinaryRoundTrip(const std::string &label, const std::vector<Command> &commands) {
+    std::ostringstream out;
+    BinaryCommandWriter writer(out);
+    writer.WriteHeader(0, 0, static_cast<uint32_t>(commands.size()));
+    for (const Command &command: commands) {
+        writer.Write(command);
+    }
+    std::string data = out.str();
+    BinaryCommandReader reader(data.data(), data.data() + data.size());
+    uint32_t teams, robots, count;
+    std::vector<Command> decoded;
+    Command command{};
+    if (reader.ReadHeader(teams, robots, count)) {
+        for (uint32_t i = 0; i < count && reader.ReadCommand(command); i++) {
+            decoded.push_back(command);
+        }
+    }
+    if (decoded.size() != commands.size() ||
+        !std::equal(decoded.begin(), decoded.end(), commands.begin(), SameCommand)) {
+        std::printf("BINARY ROUND TRIP FAILED %s: decoded %zu of %zu commands\n", label.c_str(), decoded.size(),
+                    commands.size());
+        return false;
+    }
+    return true;
+}
+
+// 指令流的文本形式，mangle为true时随机把部分换行换成空格、部分空格换成换行，使指令跨行
+std::string CommandText(const std::vector<Command> &commands, bool mangle, uint64_t seed) {
+    std::ostringstream out;
+    WriteWorkload(out, commands);
+    std::string text = out.str();
+    // 去掉开头的指令数量
+    text.erase(0, text.find('\n') + 1);
+    if (mangle) {
+        SplitMix64 rng(seed);
+        for (char &c: text) {
+            if ((c == '\n' || c == ' ') && rng.Uniform(20) == 0) {
+                c = (c == '\n') ? ' ' : '\n';
+            }
+        }
+    }
+    return text;
+}
+
+// 参考实现处理整条指令流的全部输出
+std::string ReferenceOutput(const std::vector<Command> &commands) {
+    std::ostringstream output;
+    reference::RobotManager reference_manager(output);
+    for (const Command &command: commands) {
+        reference::HandleCommand(reference_manager, command);
+    }
+    return output.str();
+}
+
+// 经流水线处理指令流的文本形式，队列容量取1（每条指令都要等待对方）和较大的值，输出须与参考实现一致
+bool CheckPipeline(const std::string &label, const std::vector<Command> &commands, const std::string &expected) {
+    std::string text = CommandText(commands, false, 0);
+    for (size_t capacity: {size_t{1}, size_t{64}}) {
+        std::ostringstream actual;
+        {
+            RobotManager manager(TickMode::kScheduled, DeathWriter(actual));
+            CommandReader reader(text.data(), text.data() + text.size());
+            ParseCommandsPipelined(reader, static_cast<uint32_t>(commands.size()), capacity,
+                                   [&](const Command &command) { manager.HandleCommand(command); });
+            manager.FlushOutput();
+        }
+        if (actual.view() != expected) {
+            std::printf("PIPELINE DIVERGED %s capacity=%zu: %zu output bytes, expected %zu\n", label.c_str(),
+                        capacity, actual.view().size(), expected.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+// 把每条指令流当作一场比赛，用很小的分段和同时进行数在多个线程上一起处理，每场的输出须与参考实现一致。
+// 奇数场编码成二进制格式，两种输入格式都会被覆盖；同步和异步输出各运行一遍
+bool CheckMatchRunner(const std::vector<std::vector<Command> > &streams) {
+    std::vector<std::string> inputs;
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < streams.size(); i++) {
+        std::ostringstream input;
+        if (i % 2 == 1) {
+            BinaryCommandWriter writer(input);
+            writer.WriteHeader(0, 0, static_cast<uint32_t>(streams[i].size()));
+            for (const Command &command: streams[i]) {
+                writer.Write(command);
+            }
+        } else {
+            WriteWorkload(input, streams[i]);
+        }
+        inputs.push_back(input.str());
+        expected.push_back(ReferenceOutput(streams[i]));
+    }
+    for (bool async_output: {false, true}) {
+        std::vector<std::ostringstream> actual(streams.size());
+        MatchRunner runner(4, 7, 3, async_output);
+        for (size_t i = 0; i < streams.size(); i++) {
+            runner.AddMatch(std::to_string(i), inputs[i].data(), inputs[i].data() + inputs[i].size(), actual[i]);
+        }
+        runner.Run();
+        for (size_t i = 0; i < streams.size(); i++) {
+            if (actual[i].view() != expected[i]) {
+                std::printf("MATCH RUNNER DIVERGED on stream #%zu%s: %zu output bytes, expected %zu\n", i,
+                            async_output ? " with async output" : "", actual[i].view().size(), expected[i].size());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 不设稠密ID范围、ID分散到哈希索引，反复击毁再复活同一批机器人：预热几轮之后，
+// 存活索引、击毁池和各存储的容量都已足够，之后的击毁、复活不应再分配内存
+bool CheckSteadyStateAllocations() {
+    constexpr uint32_t kRobots = 1000;
+    constexpr uint32_t kWarmupRounds = 2;
+    constexpr uint32_t kRounds = 10;
+    std::ostream discard(nullptr);
+    RobotManager manager(TickMode::kScheduled, DeathWriter(discard));
+    uint32_t time = 0;
+    auto key = [](uint32_t i) { return RobotKey::Pack(i * 7919 + 3, i); };
+    auto revive_all = [&] {
+        for (uint32_t i = 0; i < kRobots; i++) {
+            manager.HandleCommand({++time, 'A', key(i).TeamId(), key(i).RobotId(), i % 2});
+            if (manager.FindLiveRobot(key(i)) == nullptr) return false;
+        }
+        return true;
+    };
+    auto kill_all = [&] {
+        for (uint32_t i = 0; i < kRobots; i++) {
+            manager.HandleCommand({++time, 'F', key(i).TeamId(), key(i).RobotId(), 1000000});
+            if (manager.FindLiveRobot(key(i)) != nullptr) return false;
+        }
+        return true;
+    };
+    bool ok = revive_all();
+    for (uint32_t round = 0; ok && round < kWarmupRounds; round++) {
+        ok = kill_all() && revive_all();
+    }
+    uint64_t before = g_allocations.load(std::memory_order_relaxed);
+    for (uint32_t round = 0; ok && round < kRounds; round++) {
+        ok = kill_all() && revive_all();
+    }
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - before;
+    if (!ok) {
+        std::printf("STEADY STATE: kill/revive churn did not kill or revive every robot\n");
+        return false;
+    }
+    if (allocations != 0) {
+        std::printf("STEADY STATE ALLOCATED: %llu allocation(s) in %u kill/revive cycles\n",
+                    static_cast<unsigned long long>(allocations), kRobots * kRounds);
+        return false;
+    }
+    return true;
+}
+
+std::string FormatCommand(const Command &command) {
+    std::ostringstream out;
+    out << command.time << ' ' << (command.cmd != 0 ? command.cmd : '?') << ' ' << command.p1 << ' '
+        << command.p2 << ' ' << command.p3;
+    return out.str();
+}
+
+// 逐条比较，全部一致返回true，否则报告第一条输出不一致的指令
+bool RunDifferential(const std::string &label, const std::vector<Command> &commands, const OracleOptions &options) {
+    std::ostringstream expected;
+    reference::RobotManager reference_manager(expected);
+
+    constexpr size_t kEngineCount = std::size(kEngines);
+    std::ostringstream actual[kEngineCount];
+    std::vector<std::unique_ptr<RobotManager> > managers;
+    for (size_t e = 0; e < kEngineCount; e++) {
+        managers.push_back(std::make_unique<RobotManager>(kEngines[e].mode, MakeWriter(kEngines[e], actual[e]), false,
+                                                        kEngines[e].dense_ids));
+    }
+
+    size_t expected_offset = 0;
+    for (size_t i = 0; i < commands.size(); i++) {
+        reference::HandleCommand(reference_manager, commands[i]);
+        std::string_view expected_new = expected.view().substr(expected_offset);
+        for (size_t e = 0; e < kEngineCount; e++) {
+            managers[e]->HandleCommand(commands[i]);
+            if (!kEngines[e].flush_each_batch) {
+                managers[e]->FlushOutput();
+            } else {
+                managers[e]->EndBatch();
+                if (kEngines[e].async_queue != 0) continue;
+            }
+            std::string_view actual_new = actual[e].view().substr(expected_offset);
+            if (actual_new != expected_new) {
+                std::printf("DIVERGED %s engine=%s at command #%zu: %s\n", label.c_str(), kEngines[e].name, i,
+                            FormatCommand(commands[i]).c_str());
+                std::printf("  expected output:\n%.*s", static_cast<int>(expected_new.size()), expected_new.data());
+                std::printf("  actual output:\n%.*s", static_cast<int>(actual_new.size()), actual_new.data());
+                if (!options.save_path.empty()) {
+                    std::ofstream save(options.save_path);
+                    std::vector<Command> prefix(commands.begin(), commands.begin() + static_cast<long>(i) + 1);
+                    WriteWorkload(save, prefix);
+                    std::printf("  input saved to %s\n", options.save_path.c_str());
+                }
+                return false;
+            }
+        }
+        expected_offset = expected.view().size();
+    }
+    for (size_t e = 0; e < kEngineCount; e++) {
+        managers[e]->FlushOutput();
+        if (actual[e].view() != expected.view()) {
+            std::printf("DIVERGED %s engine=%s by the end of the stream: %zu output bytes, expected %zu\n",
+                        label.c_str(), kEngines[e].name, actual[e].view().size(), expected.view().size());
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    OracleOptions options;
+    if (!ParseArgs(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--trials=N] [--commands=N] [--seed=N] [--save=PATH] [input files...]\n",
+                     argv[0]);
+        return 2;
+    }
+    if (!CheckSteadyStateAllocations()) return 1;
+
+    std::vector<std::vector<Command> > streams;
+    if (!options.files.empty()) {
+        for (const std::string &path: options.files) {
+            std::vector<Command> commands = LoadCommands(path);
+            if (!RunDifferential(path, commands, options)) return 1;
+            if (!CheckParallelParse(path, CommandText(commands, false, 0))) return 1;
+            if (!CheckBinaryRoundTrip(path, commands)) return 1;
+            if (!CheckPipeline(path, commands, ReferenceOutput(commands))) return 1;
+            streams.push_back(std::move(commands));
+        }
+        if (!CheckMatchRunner(streams)) return 1;
+        std::printf("OK: %zu file(s) identical across %zu engine(s)\n", options.files.size(), std::size(kEngines));
+        return 0;
+    }
+
+    for (uint32_t trial = 0; trial < options.trials; trial++) {
+        uint64_t seed = options.seed + trial;
+        std::vector<Command> commands = GenerateFuzzCommands(seed, options.commands);
+        std::string label = "seed=" + std::to_string(seed);
+        if (!RunDifferential(label, commands, options)) return 1;
+        if (!CheckParallelParse(label, CommandText(commands, false, seed))) return 1;
+        if (!CheckParallelParse(label + " mangled", CommandText(commands, true, seed))) return 1;
+        if (!CheckBinaryRoundTrip(label, commands)) return 1;
+        if (!CheckPipeline(label, commands, ReferenceOutput(commands))) return 1;
+        streams.push_back(std::move(commands));
+    }
+    if (!CheckMatchRunner(streams)) return 1;
+    std::printf("OK: %u trial(s) of %u commands identical across %zu engine(s)\n", options.trials, options.commands,
+                std::size(kEngines));
+    return 0;
+}
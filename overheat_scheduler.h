@@ -0,0 +1,107 @@
+#ifndef UNTITLED1_OVERHEAT_SCHEDULER_H
+#define UNTITLED1_OVERHEAT_SCHEDULER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "robot.h"
+
+// 过热调度器：以唤醒时间为键的小根堆，只保存热量超过上限的机器人。
+// 唤醒时间取机器人冷却到热量上限以下与血量耗尽两者中较早的时刻；
+// 机器人记录自己在堆中的下标，因此安排、改期和撤销都是O(log n)。
+// 唤醒时间与机器人指针一起存放在堆数组中，调整堆时只比较连续的堆元素，不访问机器人对象
+class OverheatScheduler {
+public:
+    bool Empty() const {
+        return heap_.empty();
+    }
+
+    Robot *Top() const {
+        return heap_.front().robot;
+    }
+
+    uint64_t TopWakeTime() const {
+        return heap_.front().wake_time;
+    }
+
+    //安排机器人在wake_time唤醒，已在堆中则改期
+    void Schedule(Robot *robot, uint64_t wake_time) {
+        size_t pos = robot->heap_pos_;
+        if (pos == Robot::kNotScheduled) {
+            pos = heap_.size();
+            heap_.push_back({wake_time, robot});
+        } else {
+            heap_[pos].wake_time = wake_time;
+        }
+        SiftUp(pos);
+        SiftDown(robot->heap_pos_);
+    }
+
+    //撤销机器人的唤醒，不在堆中则什么也不做
+    void Cancel(Robot *robot) {
+        size_t pos = robot->heap_pos_;
+        if (pos == Robot::kNotScheduled) return;
+        robot->heap_pos_ = Robot::kNotScheduled;
+        Entry last = heap_.back();
+        heap_.pop_back();
+        //用堆尾元素填补空位后重新调整位置
+        if (pos < heap_.size()) {
+            Place(pos, last);
+            SiftUp(pos);
+            SiftDown(last.robot->heap_pos_);
+        }
+    }
+
+    //取出唤醒时间最早的机器人
+    Robot *Pop() {
+        Robot *robot = heap_.front().robot;
+        Cancel(robot);
+        return robot;
+    }
+
+    //堆元素的字节数
+    static constexpr size_t EntrySize() {
+        return sizeof(Entry);
+    }
+
+private:
+    struct Entry {
+        uint64_t wake_time;
+        Robot *robot;
+    };
+
+    std::vector<Entry> heap_;
+
+    void Place(size_t pos, const Entry &entry) {
+        heap_[pos] = entry;
+        entry.robot->heap_pos_ = pos;
+    }
+
+    void SiftUp(size_t pos) {
+        Entry entry = heap_[pos];
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (heap_[parent].wake_time <= entry.wake_time) break;
+            Place(pos, heap_[parent]);
+            pos = parent;
+        }
+        Place(pos, entry);
+    }
+
+    void SiftDown(size_t pos) {
+        Entry entry = heap_[pos];
+        while (true) {
+            size_t child = 2 * pos + 1;
+            if (child >= heap_.size()) break;
+            if (child + 1 < heap_.size() && heap_[child + 1].wake_time < heap_[child].wake_time) {
+                child++;
+            }
+            if (heap_[child].wake_time >= entry.wake_time) break;
+            Place(pos, heap_[child]);
+            pos = child;
+        }
+        Place(pos, entry);
+    }
+};
+
+#endif //UNTITLED1_OVERHEAT_SCHEDULER_H
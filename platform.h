@@ -0,0 +1,14 @@
+#ifndef UNTITLED1_PLATFORM_H
+#define UNTITLED1_PLATFORM_H
+
+// 平台相关的系统头文件。类Unix系统上可以用mmap映射文件和申请内存，此时定义ROBOT_HAVE_MMAP；
+// 其他平台不定义，各处退回标准库实现
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ROBOT_HAVE_MMAP 1
+#endif
+
+#endif //UNTITLED1_PLATFORM_H
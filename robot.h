@@ -0,0 +1,145 @@
+#ifndef UNTITLED1_ROBOT_H
+#define UNTITLED1_ROBOT_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "robot_store.h"
+
+// 机器人：属性保存在RobotStore中属于它的一行。步兵和工程的差别只在行中的类型上，
+// 由Rebuild等函数按类型分支处理，不使用虚函数，调用可在编译期确定并内联
+class Robot {
+public:
+    // 分配一行，赋值两种机器人通用的属性（双ID、机器人类别、等级），再按类型和等级初始化其余属性。
+    // 新建的机器人等级为1，复活时沿用击毁前的等级。
+    // 回收行会移动其他机器人的行，所以所占的行由RobotManager在销毁机器人时回收，见RobotManager::KillRobot
+    Robot(RobotStore &store, RobotKey key, RobotType type, uint32_t level = 1)
+        : store_(store), row_(store.Allocate(this, key, type, level)) {
+        Rebuild();
+    }
+
+    Robot(const Robot &) = delete;
+    Robot &operator=(const Robot &) = delete;
+
+    // 获取队伍ID和机器人ID打包成的键
+    RobotKey GetKey() const {
+        return store_.key[row_];
+    }
+
+    // 返回机器人等级
+    uint32_t GetLevel() const {
+        return store_.level[row_];
+    }
+
+    // 返回机器人类型
+    RobotType GetType() const {
+        return store_.type[row_];
+    }
+
+    // 判断机器人是否击毁
+    bool IsDead() const {
+        if (store_.blood[row_] <= 0) {
+            return true;
+        }
+        return false;
+    }
+
+    // 把热量和血量从最近一次更新时刻推算到时刻now，见RobotStore::Materialize
+    void Materialize(uint32_t now, uint32_t prev_tick) {
+        store_.Materialize(row_, now, prev_tick);
+    }
+
+    // 从时刻now开始记录状态，新建或复活时调用
+    void ResetClock(uint32_t now) {
+        store_.last_update[row_] = now;
+    }
+
+    // 判断热量是否大于0
+    bool HasHeat() const {
+        return store_.heat[row_] > 0;
+    }
+
+    // 判断热量是否超过上限
+    bool IsOverheated() const {
+        return store_.heat[row_] > store_.max_heat[row_];
+    }
+
+    // 过热时需要再次检查的时刻：冷却到上限以下与血量耗尽两者中较早者
+    uint64_t WakeTime() const {
+        uint64_t last_update = store_.last_update[row_];
+        uint64_t cool_time = last_update + (store_.heat[row_] - store_.max_heat[row_]);
+        uint64_t death_time = last_update + store_.blood[row_];
+        return std::min(cool_time, death_time);
+    }
+
+    // 扣血，如果掉血量高于现有血量直接归零
+    void TakeDamage(uint32_t damage) {
+        uint32_t &blood = store_.blood[row_];
+        blood = blood > damage ? (blood - damage) : 0;
+    }
+
+    // 按类型恢复属性：热量清零，血量回满
+    void Rebuild() {
+        uint32_t &max_blood = store_.max_blood[row_];
+        uint32_t &max_heat = store_.max_heat[row_];
+        switch (GetType()) {
+            case RobotType::kInfantry: {
+                // 步兵根据等级不同属性赋值不同
+                switch (store_.level[row_]) {
+                    case 2: {
+                        max_blood = 150;
+                        max_heat = 200;
+                        break;
+                    }
+                    case 3: {
+                        max_blood = 250;
+                        max_heat = 300;
+                        break;
+                    }
+                    default: {
+                        max_blood = 100;
+                        max_heat = 100;
+                    }
+                }
+                break;
+            }
+            case RobotType::kEngineer: {
+                // 工程无热量，血量上限300
+                max_blood = 300;
+                max_heat = 0;
+                break;
+            }
+        }
+        store_.heat[row_] = 0;
+        store_.blood[row_] = max_blood;
+    }
+
+    // 步兵升级，调用方须保证是步兵
+    bool Upgrade(uint32_t target_level) {
+        uint32_t &level = store_.level[row_];
+        if (target_level > level && target_level <= 3) {
+            level = target_level;
+            Rebuild();
+            return true;
+        }
+        return false;
+    }
+
+    // 步兵热量增加，调用方须保证是步兵
+    void AddHeat(uint32_t add_heat) {
+        store_.heat[row_] += add_heat;
+    }
+
+private:
+    // 所在的存储和行号
+    friend class RobotManager;
+    RobotStore &store_;
+    uint32_t row_;
+
+    // 在过热调度器中的堆下标，唤醒时间存放在堆元素中
+    friend class OverheatScheduler;
+    static constexpr size_t kNotScheduled = static_cast<size_t>(-1);
+    size_t heap_pos_ = kNotScheduled;
+};
+
+#endif //UNTITLED1_ROBOT_H
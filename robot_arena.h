@@ -0,0 +1,90 @@
+#ifndef UNTITLED1_ROBOT_ARENA_H
+#define UNTITLED1_ROBOT_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "platform.h"
+
+// 内存区：向系统整块申请内存，按顺序切给调用方，只在析构时整体归还。
+// 槽位的回收复用由使用方负责，因此机器人的新建与销毁不经过全局分配器。
+// 开启大页时整块按2MiB对齐并建议内核使用透明大页，减少大量机器人时的TLB缺失
+class RobotArena {
+public:
+    static constexpr size_t kBlockSize = size_t{2} << 20;
+
+    explicit RobotArena(bool huge_pages = false) : huge_pages_(huge_pages) {
+    }
+
+    ~RobotArena() {
+        for (const Block &block: blocks_) {
+            FreeBlock(block);
+        }
+    }
+
+    RobotArena(const RobotArena &) = delete;
+    RobotArena &operator=(const RobotArena &) = delete;
+
+    // 切出一段按align对齐的内存，当前块不够时整块申请，块大小至少为kBlockSize
+    void *Allocate(size_t bytes, size_t align) {
+        size_t offset = (used_ + align - 1) & ~(align - 1);
+        if (blocks_.empty() || offset + bytes > blocks_.back().size) {
+            size_t size = (bytes + kBlockSize - 1) / kBlockSize * kBlockSize;
+            blocks_.push_back(AllocateBlock(size));
+            offset = 0;
+        }
+        used_ = offset + bytes;
+        return static_cast<char *>(blocks_.back().data) + offset;
+    }
+
+private:
+    struct Block {
+        void *data;
+        size_t size;
+        bool mapped;
+    };
+
+    bool huge_pages_;
+    std::vector<Block> blocks_;
+    // 最后一块已使用的字节数
+    size_t used_ = 0;
+
+    Block AllocateBlock(size_t size) {
+#ifdef ROBOT_HAVE_MMAP
+        if (huge_pages_) {
+            // 多申请一块用于对齐，再把对齐范围外的部分还给系统
+            size_t mapped_size = size + kBlockSize;
+            void *data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data != MAP_FAILED) {
+                auto begin = reinterpret_cast<uintptr_t>(data);
+                uintptr_t aligned = (begin + kBlockSize - 1) & ~(uintptr_t{kBlockSize} - 1);
+                if (aligned != begin) {
+                    munmap(data, aligned - begin);
+                }
+                if (aligned + size != begin + mapped_size) {
+                    munmap(reinterpret_cast<void *>(aligned + size), begin + mapped_size - aligned - size);
+                }
+#ifdef MADV_HUGEPAGE
+                madvise(reinterpret_cast<void *>(aligned), size, MADV_HUGEPAGE);
+#endif
+                return {reinterpret_cast<void *>(aligned), size, true};
+            }
+        }
+#endif
+        return {::operator new(size, std::align_val_t{alignof(std::max_align_t)}), size, false};
+    }
+
+    static void FreeBlock(const Block &block) {
+#ifdef ROBOT_HAVE_MMAP
+        if (block.mapped) {
+            munmap(block.data, block.size);
+            return;
+        }
+#endif
+        ::operator delete(block.data, std::align_val_t{alignof(std::max_align_t)});
+    }
+};
+
+#endif //UNTITLED1_ROBOT_ARENA_H
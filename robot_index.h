@@ -0,0 +1,126 @@
+#ifndef UNTITLED1_ROBOT_INDEX_H
+#define UNTITLED1_ROBOT_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "robot_key.h"
+#include "robot_key_map.h"
+
+// 稠密ID范围：队伍ID小于teams且机器人ID小于robots的机器人直接按下标寻址，任一为0表示不启用
+struct DenseIdRange {
+    uint32_t teams = 0;
+    uint32_t robots = 0;
+
+    bool Enabled() const {
+        return teams != 0 && robots != 0;
+    }
+};
+
+// 以机器人键为索引的表：启用稠密ID范围时，范围内的键存放在按[队伍][机器人]排列的二维数组中，
+// 查找只是一次下标运算；范围外的键自动退回哈希表，因此任何ID都能存取。
+// 数组的格子直接存放值，等于kEmpty的格子表示没有元素，所以kEmpty不能作为值插入。
+// 每个队伍的一行在第一次插入该队伍的键时才申请；范围来自输入，整张数组的字节数超过kMaxDenseBytes时不启用，
+// 全部ID退回哈希表，避免按输入申请任意大的内存
+template<typename Value, Value kEmpty = Value{}>
+class RobotIndex {
+public:
+    static constexpr uint64_t kMaxDenseBytes = uint64_t{1} << 25;
+
+    // 设置稠密ID范围，已有的元素按新范围重新放置
+    void SetDenseRange(DenseIdRange range) {
+        std::vector<std::pair<RobotKey, Value> > entries;
+        for (uint32_t team = 0; team < rows_.size(); team++) {
+            if (!rows_[team]) continue;
+            for (uint32_t robot = 0; robot < range_.robots; robot++) {
+                if (rows_[team][robot] != kEmpty) {
+                    entries.emplace_back(RobotKey::Pack(team, robot), rows_[team][robot]);
+                }
+            }
+        }
+        hashed_.ForEach([&](RobotKey key, const Value &value) {
+            entries.emplace_back(key, value);
+        });
+        range_ = Fits(range) ? range : DenseIdRange{};
+        rows_.clear();
+        rows_.resize(range_.teams);
+        hashed_.Clear();
+        for (auto &[key, value]: entries) {
+            Insert(key, std::move(value));
+        }
+    }
+
+    // 查找键对应的值，不存在返回nullptr
+    Value *Find(RobotKey key) {
+        if (InRange(key)) {
+            Value *row = rows_[key.TeamId()].get();
+            if (row == nullptr || row[key.RobotId()] == kEmpty) return nullptr;
+            return &row[key.RobotId()];
+        }
+        return hashed_.Find(key);
+    }
+
+    const Value *Find(RobotKey key) const {
+        return const_cast<RobotIndex *>(this)->Find(key);
+    }
+
+    // 插入或覆盖键对应的值
+    Value &Insert(RobotKey key, Value value) {
+        if (InRange(key)) {
+            return Row(key.TeamId())[key.RobotId()] = std::move(value);
+        }
+        return hashed_.InsertOrAssign(key, std::move(value));
+    }
+
+    // 取键对应的值，不存在时先插入默认值
+    Value &operator[](RobotKey key) {
+        Value *value = Find(key);
+        return value != nullptr ? *value : Insert(key, Value{});
+    }
+
+    // 删除键，不存在则什么也不做
+    void Erase(RobotKey key) {
+        if (InRange(key)) {
+            Value *row = rows_[key.TeamId()].get();
+            if (row != nullptr) {
+                row[key.RobotId()] = kEmpty;
+            }
+        } else {
+            hashed_.Erase(key);
+        }
+    }
+
+private:
+    DenseIdRange range_;
+    // 稠密部分，每个队伍一行，下标为机器人ID；尚无元素的队伍为空
+    std::vector<std::unique_ptr<Value[]> > rows_;
+    // 范围外的键，反复插入删除时不分配内存
+    RobotKeyMap<Value> hashed_;
+
+    // 范围启用且整张数组（含各行的指针）不超过kMaxDenseBytes
+    static bool Fits(DenseIdRange range) {
+        if (!range.Enabled()) return false;
+        uint64_t bytes = static_cast<uint64_t>(range.teams) * sizeof(std::unique_ptr<Value[]>) +
+                         static_cast<uint64_t>(range.teams) * range.robots * sizeof(Value);
+        return bytes <= kMaxDenseBytes;
+    }
+
+    bool InRange(RobotKey key) const {
+        return key.TeamId() < range_.teams && key.RobotId() < range_.robots;
+    }
+
+    // 取队伍的一行，第一次使用时申请并全部置为kEmpty
+    Value *Row(uint32_t team) {
+        std::unique_ptr<Value[]> &row = rows_[team];
+        if (!row) {
+            row.reset(new Value[range_.robots]);
+            std::fill_n(row.get(), range_.robots, kEmpty);
+        }
+        return row.get();
+    }
+};
+
+#endif //UNTITLED1_ROBOT_INDEX_H
@@ -0,0 +1,27 @@
+#ifndef UNTITLED1_ROBOT_KEY_H
+#define UNTITLED1_ROBOT_KEY_H
+
+#include <compare>
+#include <cstdint>
+
+// 机器人双ID打包成的64位键：高32位为队伍ID，低32位为机器人ID。
+// 比较、排序都是一次整数比较，按键排序即按（队伍ID，机器人ID）的字典序
+struct RobotKey {
+    uint64_t value = 0;
+
+    static constexpr RobotKey Pack(uint32_t team_id, uint32_t robot_id) {
+        return {(static_cast<uint64_t>(team_id) << 32) | robot_id};
+    }
+
+    constexpr uint32_t TeamId() const {
+        return static_cast<uint32_t>(value >> 32);
+    }
+
+    constexpr uint32_t RobotId() const {
+        return static_cast<uint32_t>(value);
+    }
+
+    constexpr auto operator<=>(const RobotKey &) const = default;
+};
+
+#endif //UNTITLED1_ROBOT_KEY_H
@@ -0,0 +1,136 @@
+#ifndef UNTITLED1_ROBOT_KEY_MAP_H
+#define UNTITLED1_ROBOT_KEY_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "robot_key.h"
+
+// 以机器人键为键的开放寻址哈希表：所有元素放在一个连续数组中，冲突时线性探测下一格，
+// 删除时把后面同一探测链上的元素前移填补空位（不留墓碑），所以查找不会越来越慢。
+// 数组只在元素数超过容量一半时加倍，删除后不缩小，反复插入删除（击毁、复活）时不再分配内存。
+// 插入可能扩容，之前取得的值指针随之失效
+template<typename Value>
+class RobotKeyMap {
+public:
+    // 查找键对应的值，不存在返回nullptr
+    Value *Find(RobotKey key) {
+        size_t pos = FindPos(key);
+        return pos != kNotFound ? &slots_[pos].value : nullptr;
+    }
+
+    // 插入或覆盖键对应的值
+    Value &InsertOrAssign(RobotKey key, Value value) {
+        size_t pos = FindPos(key);
+        if (pos != kNotFound) {
+            return slots_[pos].value = std::move(value);
+        }
+        if ((size_ + 1) * 2 > slots_.size()) {
+            Grow();
+        }
+        pos = Home(key);
+        while (slots_[pos].used) {
+            pos = Next(pos);
+        }
+        slots_[pos] = {key, std::move(value), true};
+        size_++;
+        return slots_[pos].value;
+    }
+
+    // 删除键，不存在则什么也不做
+    void Erase(RobotKey key) {
+        size_t hole = FindPos(key);
+        if (hole == kNotFound) return;
+        // 依次检查空位之后的元素，起始位置不在(空位, 当前位置]之间的元素可以前移到空位
+        for (size_t pos = Next(hole); slots_[pos].used; pos = Next(pos)) {
+            size_t mask = slots_.size() - 1;
+            if (((pos - Home(slots_[pos].key)) & mask) >= ((pos - hole) & mask)) {
+                slots_[hole] = std::move(slots_[pos]);
+                hole = pos;
+            }
+        }
+        slots_[hole].used = false;
+        size_--;
+    }
+
+    // 删除全部元素，保留已申请的容量
+    void Clear() {
+        for (Slot &slot: slots_) {
+            slot.used = false;
+        }
+        size_ = 0;
+    }
+
+    // 对每个元素调用func(key, value)，顺序不确定
+    template<typename Func>
+    void ForEach(Func &&func) const {
+        for (const Slot &slot: slots_) {
+            if (slot.used) {
+                func(slot.key, slot.value);
+            }
+        }
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+private:
+    struct Slot {
+        RobotKey key;
+        Value value{};
+        bool used = false;
+    };
+
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+    static constexpr size_t kMinCapacity = 16;
+
+    // 容量为2的幂
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    // 哈希值右移的位数，64减去容量的对数
+    unsigned shift_ = 64;
+
+    // 键的起始位置：乘以黄金分割常数后取高位，队伍ID和机器人ID的每一位都参与，打包后规律的键也能分散开
+    size_t Home(RobotKey key) const {
+        return static_cast<size_t>((key.value * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    size_t Next(size_t pos) const {
+        return (pos + 1) & (slots_.size() - 1);
+    }
+
+    size_t FindPos(RobotKey key) const {
+        if (size_ == 0) return kNotFound;
+        for (size_t pos = Home(key); slots_[pos].used; pos = Next(pos)) {
+            if (slots_[pos].key == key) return pos;
+        }
+        return kNotFound;
+    }
+
+    // 容量加倍，全部元素重新放置
+    void Grow() {
+        size_t capacity = slots_.empty() ? kMinCapacity : slots_.size() * 2;
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        shift_ = 64;
+        for (size_t bits = capacity; bits > 1; bits >>= 1) {
+            shift_--;
+        }
+        size_ = 0;
+        for (Slot &slot: old) {
+            if (slot.used) {
+                size_t pos = Home(slot.key);
+                while (slots_[pos].used) {
+                    pos = Next(pos);
+                }
+                slots_[pos] = std::move(slot);
+                size_++;
+            }
+        }
+    }
+};
+
+#endif //UNTITLED1_ROBOT_KEY_MAP_H
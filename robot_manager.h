@@ -0,0 +1,329 @@
+#ifndef UNTITLED1_ROBOT_MANAGER_H
+#define UNTITLED1_ROBOT_MANAGER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "command.h"
+#include "dead_robot_pool.h"
+#include "death_writer.h"
+#include "hot_set.h"
+#include "overheat_scheduler.h"
+#include "robot.h"
+#include "robot_index.h"
+#include "robot_key.h"
+#include "robot_slot_map.h"
+
+// 时间推进方式
+enum class TickMode {
+    // 每次时间推进按行号顺序扫描RobotStore，逐行把状态推算到当前时刻
+    kScan = 0,
+    // 只在过热机器人的唤醒时间处理它们，其余机器人的状态在被指令访问时按闭式推算
+    kScheduled = 1,
+    // 只扫描热量大于0的步兵，热量为0的步兵在时间推进中状态不变
+    kHotSet = 2
+};
+
+//时间推进的访问量统计，基准测试用来比较各推进方式每次推进触及的数据量。
+//字节数是按被处理的每一行读写的状态列和索引数组算出的估计值，不是实测，调度模式不计调整堆时移动的元素。
+//只在定义了ROBOT_TICK_STATS时统计，否则各计数的累加在编译时去掉，GetTickStats返回全0
+struct TickStats {
+    //实际发生的时间推进次数
+    uint64_t ticks = 0;
+    //被处理的行数
+    uint64_t rows_visited = 0;
+    //估计读写的字节数
+    uint64_t estimated_bytes = 0;
+    //每次推进时存活机器人数之和，即原先逐个遍历全部存活机器人的布局会处理的行数
+    uint64_t live_robots = 0;
+};
+
+//机器人管理类
+class RobotManager {
+private:
+    //机器人属性的列式存储，按类型分开：工程没有热量，不参与时间推进，只有步兵的存储需要扫描。
+    //须在持有机器人对象的容器之前构造、之后析构
+    RobotStore infantry_store_;
+    RobotStore engineer_store_;
+    //时间推进方式
+    TickMode tick_mode_;
+    //击毁事件输出器
+    DeathWriter writer_;
+    //过热调度器，仅调度模式使用
+    OverheatScheduler scheduler_;
+    //步兵存储中热量大于0的行，仅热量集合模式使用
+    HotSet hot_set_;
+    //同一次时间推进中被击毁的行及其机器人，复用以避免每次推进都分配内存
+    std::vector<uint32_t> dying_rows_;
+    std::vector<Robot *> dying_robots_;
+    //下一个加入存活池的机器人的序号
+    uint64_t next_live_seq_ = 0;
+    //持有所有存活机器人的对象
+    RobotSlotMap robots_;
+    //已击毁机器人的紧凑记录
+    DeadRobotPool dead_robots_;
+    //存活机器人的双ID索引，值为机器人所在的槽位下标，查找为O(1)，可设置稠密ID范围直接寻址。
+    //击毁时先移出索引再回收槽位，索引中的下标总是指向该机器人，不必再存代数
+    RobotIndex<uint32_t, RobotHandle::kNullIndex> live_index_;
+    //初始化时间
+    uint32_t last_time_ = 0;
+    //时间推进的访问量统计
+    TickStats tick_stats_;
+
+    //按类型取机器人所在的列式存储
+    RobotStore &StoreOf(RobotType type) {
+        return type == RobotType::kInfantry ? infantry_store_ : engineer_store_;
+    }
+
+    //机器人被击毁：按格式输出，移出存活索引，只在击毁池中留下记录，机器人对象和所占的行随即回收。
+    //回收行时存储的末行移入空出的行，被移动的机器人及热量集合中记下的行号随之更新
+    void KillRobot(Robot *robot) {
+        RobotKey key = robot->GetKey();
+        RobotType type = robot->GetType();
+        writer_.Write(key);
+        scheduler_.Cancel(robot);
+        if (type == RobotType::kInfantry) {
+            hot_set_.Erase(robot->row_);
+        }
+        dead_robots_.Add(key, type, robot->GetLevel());
+        RobotHandle handle = robots_.HandleAt(*live_index_.Find(key));
+        live_index_.Erase(key);
+        RobotStore &store = robot->store_;
+        uint32_t row = robot->row_;
+        robots_.Erase(handle);
+        uint32_t moved_from = store.Release(row);
+        if (moved_from != row) {
+            store.owner[row]->row_ = row;
+            if (type == RobotType::kInfantry) {
+                hot_set_.Move(moved_from, row);
+            }
+        }
+    }
+
+    //调度模式下把步兵的热量和血量推算到当前时刻，遍历模式下每次推进都已更新，工程的状态不随时间变化
+    void SyncRobot(Robot *robot) {
+        if (tick_mode_ != TickMode::kScheduled || robot->GetType() != RobotType::kInfantry) return;
+        robot->Materialize(last_time_, last_time_);
+    }
+
+    //调度模式下根据机器人当前状态重新安排唤醒时间，未过热则撤销
+    void RescheduleRobot(Robot *robot) {
+        if (tick_mode_ != TickMode::kScheduled) return;
+        if (robot->IsOverheated()) {
+            scheduler_.Schedule(robot, robot->WakeTime());
+        } else {
+            scheduler_.Cancel(robot);
+        }
+    }
+
+    //记录时间推进处理的行数和估计读写的字节数，未定义ROBOT_TICK_STATS时什么也不做
+    void CountRows([[maybe_unused]] uint64_t rows, [[maybe_unused]] uint64_t bytes) {
+#ifdef ROBOT_TICK_STATS
+        tick_stats_.rows_visited += rows;
+        tick_stats_.estimated_bytes += bytes;
+#endif
+    }
+
+    //调度模式下的时间推进：只处理唤醒时间已到的过热机器人。
+    //唤醒时间不晚于冷却时刻，所以上一次推进时机器人仍然过热，满足Materialize的前提
+    void AdvanceScheduled(uint32_t curr_time) {
+        while (!scheduler_.Empty() && scheduler_.TopWakeTime() <= curr_time) {
+            Robot *robot = scheduler_.Pop();
+            robot->Materialize(curr_time, last_time_);
+            CountRows(1, OverheatScheduler::EntrySize() + RobotStore::kMaterializeBytesPerRow);
+            if (robot->IsDead()) {
+                dying_rows_.push_back(robot->row_);
+            }
+        }
+    }
+
+    //同一时刻被击毁的机器人按加入存活池的顺序输出，时间推进只会击毁步兵，dying_rows_都是步兵存储的行。
+    //击毁会移动行，所以先把行号换成机器人对象再逐个击毁
+    void KillDyingRobots() {
+        std::sort(dying_rows_.begin(), dying_rows_.end(), [this](uint32_t a, uint32_t b) {
+            return infantry_store_.live_seq[a] < infantry_store_.live_seq[b];
+        });
+        for (uint32_t row: dying_rows_) {
+            dying_robots_.push_back(infantry_store_.owner[row]);
+        }
+        for (Robot *robot: dying_robots_) {
+            KillRobot(robot);
+        }
+        dying_rows_.clear();
+        dying_robots_.clear();
+    }
+
+public:
+    //huge_pages为true时机器人对象所在的内存区使用大页；dense_ids非空时范围内的ID直接寻址
+    explicit RobotManager(TickMode tick_mode = TickMode::kScheduled, DeathWriter writer = DeathWriter(),
+                          bool huge_pages = false, DenseIdRange dense_ids = {})
+        : tick_mode_(tick_mode), writer_(std::move(writer)), robots_(huge_pages) {
+        SetDenseIds(dense_ids);
+    }
+
+    //设置稠密ID范围，存活索引和击毁池都按[队伍][机器人]直接寻址，范围外的ID退回哈希索引。
+    //可在任意时刻调用，已有的机器人按新范围重新放置
+    void SetDenseIds(DenseIdRange dense_ids) {
+        live_index_.SetDenseRange(dense_ids);
+        dead_robots_.SetDenseRange(dense_ids);
+    }
+
+    //已知机器人数量时预先申请内存，之后新建机器人不再分配
+    void Reserve(uint32_t infantry_count, uint32_t engineer_count) {
+        robots_.Reserve(infantry_count + engineer_count);
+        infantry_store_.Reserve(infantry_count);
+        engineer_store_.Reserve(engineer_count);
+    }
+
+    //一批指令处理完毕，按输出器的设置决定是否写出
+    void EndBatch() {
+        writer_.EndBatch();
+    }
+
+    //时间推进的访问量统计，只在定义了ROBOT_TICK_STATS时有值
+    const TickStats &GetTickStats() const {
+        return tick_stats_;
+    }
+
+    //写出所有尚未输出的击毁事件
+    void FlushOutput() {
+        writer_.Flush();
+    }
+
+    //在活机器人索引中找机器人，返回的指针不持有所有权，查找不改动引用计数
+    Robot *FindLiveRobot(RobotKey key) {
+        const uint32_t *index = live_index_.Find(key);
+        if (index != nullptr) {
+            return robots_.Get(robots_.HandleAt(*index));
+        }
+        return nullptr;
+    }
+
+    //加入存活池，同时登记索引
+    void AddLiveRobot(RobotHandle handle) {
+        Robot *robot = robots_.Get(handle);
+        robot->store_.live_seq[robot->row_] = next_live_seq_++;
+        robot->ResetClock(last_time_);
+        live_index_.Insert(robot->GetKey(), handle.index);
+    }
+
+    //在击毁池中找双ID和类型都匹配的记录，返回其击毁前的等级，没有则返回DeadRobotPool::kNotFound
+    uint32_t FindDeadRobot(RobotKey key, RobotType type) const {
+        return dead_robots_.Find(key, type);
+    }
+
+    //处理时间变化函数
+    void HandleTimeChange(uint32_t curr_time) {
+        //如果时间不变，各参数不变，直接返回
+        if (curr_time <= last_time_) return;
+#ifdef ROBOT_TICK_STATS
+        tick_stats_.ticks++;
+        tick_stats_.live_robots += robots_.LiveCount();
+#endif
+        if (tick_mode_ == TickMode::kScheduled) {
+            AdvanceScheduled(curr_time);
+        } else if (tick_mode_ == TickMode::kHotSet) {
+            //只处理有热量的步兵，热量降为0的移出集合；每行另读集合数组中的行号
+            uint32_t rows = hot_set_.Size();
+            CountRows(rows, static_cast<uint64_t>(rows) * (RobotStore::kTickBytesPerRow + sizeof(uint32_t)));
+            hot_set_.Tick(infantry_store_, curr_time - last_time_, dying_rows_);
+        } else {
+            //按行号顺序扫描步兵的列式存储，改变所有步兵的参数；另写击毁位图
+            uint32_t rows = infantry_store_.Size();
+            CountRows(rows, static_cast<uint64_t>(rows) * RobotStore::kTickBytesPerRow +
+                            (rows + 63) / 64 * sizeof(uint64_t));
+            infantry_store_.Tick(curr_time - last_time_, dying_rows_);
+        }
+        //参数改变后死亡的机器人移到击毁池，并按格式输出
+        KillDyingRobots();
+        last_time_ = curr_time;
+    }
+
+    //处理指令A，添加或复活机器人
+    void HandleCommandA(uint32_t team_id, uint32_t robot_id, RobotType type) {
+        //若机器人已存在且未死亡则指令无效返回
+        RobotKey key = RobotKey::Pack(team_id, robot_id);
+        if (FindLiveRobot(key) != nullptr) return;
+        //查找机器人是否在击毁池中，若在则复活
+        uint32_t level = FindDeadRobot(key, type);
+        if (level != DeadRobotPool::kNotFound) {
+            //按记录中的等级重新构造机器人，构造时Rebuild恢复其余属性
+            AddLiveRobot(robots_.Emplace(StoreOf(type), key, type, level));
+            //在击毁池中删除该双ID的所有记录
+            dead_robots_.RemoveId(key);
+            return;
+        }
+
+        //若不在击毁池中，则按类别在对应的存储中新建该机器人，类别无效时不新建
+        if (type == RobotType::kInfantry || type == RobotType::kEngineer) {
+            AddLiveRobot(robots_.Emplace(StoreOf(type), key, type));
+        }
+    }
+
+    //处理F指令，机器人扣血指令
+    void HandleCommandF(uint32_t team_id, uint32_t robot_id, uint32_t damage) {
+        //在存活机器人中找该机器人
+        auto robot = FindLiveRobot(RobotKey::Pack(team_id, robot_id));
+        //如果没找到或者已击毁，则指令无效返回
+        if (robot == nullptr || robot->IsDead()) return;
+        SyncRobot(robot);
+        //更新血量，如果掉血量高于现有血量直接归零
+        robot->TakeDamage(damage);
+        //判断机器人掉血后是否被击毁，如被击毁则移到击毁池，并按规定输出
+        if (robot->IsDead()) {
+            KillRobot(robot);
+        } else {
+            RescheduleRobot(robot);
+        }
+    }
+
+    //处理H指令，只针对步兵，增加热量
+    void HandleCommandH(uint32_t team_id, uint32_t robot_id, uint32_t add_heat) {
+        //在存活池中找到目标机器人
+        auto robot = FindLiveRobot(RobotKey::Pack(team_id, robot_id));
+        //没找到或其类型不是步兵则指令无效直接返回
+        if (robot == nullptr || robot->GetType() != RobotType::kInfantry) return;
+        SyncRobot(robot);
+        robot->AddHeat(add_heat);
+        RescheduleRobot(robot);
+        //热量集合模式下有热量的步兵加入集合；升级清零热量后不立即移除，下一次时间推进时自然移出
+        if (tick_mode_ == TickMode::kHotSet && robot->HasHeat()) {
+            hot_set_.Insert(robot->row_);
+        }
+    }
+
+    //处理一条输入指令：先推进时间，再按不同cmd类型分别调用对应的处理函数
+    void HandleCommand(const Command &command) {
+        HandleTimeChange(command.time);
+        switch (command.cmd) {
+            case 'A':
+                HandleCommandA(command.p1, command.p2, static_cast<RobotType>(command.p3));
+                break;
+            case 'F':
+                HandleCommandF(command.p1, command.p2, command.p3);
+                break;
+            case 'H':
+                HandleCommandH(command.p1, command.p2, command.p3);
+                break;
+            case 'U':
+                HandCommandU(command.p1, command.p2, command.p3);
+                break;
+            default:
+                break;
+        }
+    }
+
+    //处理指令U，只针对步兵，对机器人升级
+    void HandCommandU(uint32_t team_id, uint32_t robot_id, uint32_t target_level) {
+        //在存活池中找到目标机器人
+        auto robot = FindLiveRobot(RobotKey::Pack(team_id, robot_id));
+        //没找到或其类型不是步兵则指令无效直接返回
+        if (robot == nullptr || robot->GetType() != RobotType::kInfantry) return;
+        SyncRobot(robot);
+        robot->Upgrade(target_level);
+        RescheduleRobot(robot);
+    }
+};
+
+#endif //UNTITLED1_ROBOT_MANAGER_H
@@ -0,0 +1,129 @@
+#ifndef UNTITLED1_ROBOT_SLOT_MAP_H
+#define UNTITLED1_ROBOT_SLOT_MAP_H
+
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "robot.h"
+#include "robot_arena.h"
+
+// 机器人句柄：槽位下标加代数，槽位被回收后代数加1，旧句柄随之失效
+struct RobotHandle {
+    static constexpr uint32_t kNullIndex = static_cast<uint32_t>(-1);
+    uint32_t index = kNullIndex;
+    uint32_t generation = 0;
+
+    bool IsNull() const {
+        return index == kNullIndex;
+    }
+
+    bool operator==(const RobotHandle &) const = default;
+};
+
+// 机器人槽位表：持有所有机器人对象，按句柄访问，查找只是下标运算，不涉及引用计数。
+// 槽位按固定大小的段从内存区中切出，机器人对象地址在其生存期内不变，RobotStore和调度器可以保存其指针；
+// 销毁的机器人所在槽位进入空闲表供新机器人复用。
+class RobotSlotMap {
+public:
+    explicit RobotSlotMap(bool huge_pages = false) : arena_(huge_pages) {
+    }
+
+    ~RobotSlotMap() {
+        for (uint32_t index = 0; index < size_; index++) {
+            At(index).~Slot();
+        }
+    }
+
+    RobotSlotMap(const RobotSlotMap &) = delete;
+    RobotSlotMap &operator=(const RobotSlotMap &) = delete;
+
+    // 预先为count个槽位申请内存，缺少的段一次性从内存区中切出
+    void Reserve(uint32_t count) {
+        size_t chunks = (static_cast<size_t>(count) + kChunkSlots - 1) / kChunkSlots;
+        if (chunks <= chunks_.size()) return;
+        size_t missing = chunks - chunks_.size();
+        auto *memory = static_cast<Slot *>(arena_.Allocate(missing * kChunkSlots * sizeof(Slot), alignof(Slot)));
+        for (size_t i = 0; i < missing; i++) {
+            chunks_.push_back(memory + i * kChunkSlots);
+        }
+    }
+
+    // 在空闲槽位或新槽位中构造一个机器人
+    template<typename... Args>
+    RobotHandle Emplace(Args &&... args) {
+        uint32_t index;
+        if (!free_slots_.empty()) {
+            index = free_slots_.back();
+            free_slots_.pop_back();
+        } else {
+            index = size_;
+            if (index == chunks_.size() * kChunkSlots) {
+                Reserve(index + 1);
+            }
+            new(&At(index)) Slot();
+            size_++;
+        }
+        Slot &slot = At(index);
+        slot.robot.emplace(std::forward<Args>(args)...);
+        return {index, slot.generation};
+    }
+
+    // 按句柄取机器人，句柄已失效返回nullptr
+    Robot *Get(RobotHandle handle) {
+        if (handle.index >= size_) return nullptr;
+        Slot &slot = At(handle.index);
+        if (slot.generation != handle.generation || !slot.robot) return nullptr;
+        return &*slot.robot;
+    }
+
+    // 槽位index中当前机器人的句柄，槽位为空时返回空句柄；只存槽位下标的索引用它换回句柄
+    RobotHandle HandleAt(uint32_t index) const {
+        if (index >= size_) return {};
+        const Slot &slot = At(index);
+        if (!slot.robot) return {};
+        return {index, slot.generation};
+    }
+
+    // 销毁机器人并回收槽位，该槽位的旧句柄全部失效
+    void Erase(RobotHandle handle) {
+        if (Get(handle) == nullptr) return;
+        Slot &slot = At(handle.index);
+        slot.robot.reset();
+        slot.generation++;
+        free_slots_.push_back(handle.index);
+    }
+
+    // 当前存活的机器人数
+    uint32_t LiveCount() const {
+        return size_ - static_cast<uint32_t>(free_slots_.size());
+    }
+
+private:
+    struct Slot {
+        std::optional<Robot> robot;
+        uint32_t generation = 0;
+    };
+
+    // 每段的槽位数
+    static constexpr uint32_t kChunkSlots = 1024;
+
+    RobotArena arena_;
+    // 各段的起始地址，槽位index位于第index / kChunkSlots段
+    std::vector<Slot *> chunks_;
+    // 已构造的槽位数
+    uint32_t size_ = 0;
+    std::vector<uint32_t> free_slots_;
+
+    Slot &At(uint32_t index) {
+        return chunks_[index / kChunkSlots][index % kChunkSlots];
+    }
+
+    const Slot &At(uint32_t index) const {
+        return chunks_[index / kChunkSlots][index % kChunkSlots];
+    }
+};
+
+#endif //UNTITLED1_ROBOT_SLOT_MAP_H
@@ -0,0 +1,130 @@
+#ifndef UNTITLED1_ROBOT_STORE_H
+#define UNTITLED1_ROBOT_STORE_H
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "robot_key.h"
+#include "robot_type.h"
+#include "tick_kernel.h"
+
+class Robot;
+
+// 机器人属性的列式存储：每个属性一列连续数组，同一机器人在各列中的下标（行号）相同，
+// 遍历模式的时间推进按行号顺序扫描热量、热量上限、血量三列。
+// 时间推进只访问这三列（调度模式另加last_update），双ID、类型、等级、血量上限等其余各列不会被带进缓存。
+// 各列始终紧凑：回收一行时把末行移入空出的行，遍历模式扫描的行数等于存活的机器人数，中间没有空洞
+class RobotStore {
+public:
+    // 时间推进每处理一行读写的字节数：热量、热量上限、血量各一个uint32
+    static constexpr size_t kTickBytesPerRow = 3 * sizeof(uint32_t);
+    // Materialize每处理一行读写的字节数：另加last_update
+    static constexpr size_t kMaterializeBytesPerRow = kTickBytesPerRow + sizeof(uint32_t);
+
+    // 各属性列
+    std::vector<RobotKey> key;
+    std::vector<uint32_t> heat, max_heat, blood, max_blood, level;
+    std::vector<RobotType> type;
+    // heat和blood所对应的时刻
+    std::vector<uint32_t> last_update;
+    // 加入存活池的序号，同一时刻击毁多个机器人时按序号输出
+    std::vector<uint64_t> live_seq;
+    // 每一行对应的机器人对象
+    std::vector<Robot *> owner;
+
+    // 预先为count行申请内存
+    void Reserve(uint32_t count) {
+        for (auto *column: {&heat, &max_heat, &blood, &max_blood, &level, &last_update}) {
+            column->reserve(count);
+        }
+        key.reserve(count);
+        type.reserve(count);
+        live_seq.reserve(count);
+        owner.reserve(count);
+    }
+
+    // 为新机器人在末尾分配一行
+    uint32_t Allocate(Robot *robot, RobotKey robot_key, RobotType robot_type, uint32_t robot_level) {
+        auto row = static_cast<uint32_t>(owner.size());
+        for (auto *column: {&heat, &max_heat, &blood, &last_update}) {
+            column->push_back(0);
+        }
+        max_blood.push_back(0);
+        level.push_back(robot_level);
+        key.push_back(robot_key);
+        type.push_back(robot_type);
+        live_seq.push_back(0);
+        owner.push_back(robot);
+        return row;
+    }
+
+    // 回收一行：末行移入空出的行后删去末行。返回被移动的行原来的行号，回收的正是末行时返回row本身；
+    // 调用方负责更新被移动的机器人记下的行号以及其他按行号记录的结构
+    uint32_t Release(uint32_t row) {
+        auto last = static_cast<uint32_t>(owner.size() - 1);
+        if (row != last) {
+            for (auto *column: {&heat, &max_heat, &blood, &max_blood, &level, &last_update}) {
+                (*column)[row] = (*column)[last];
+            }
+            key[row] = key[last];
+            type[row] = type[last];
+            live_seq[row] = live_seq[last];
+            owner[row] = owner[last];
+        }
+        for (auto *column: {&heat, &max_heat, &blood, &max_blood, &level, &last_update}) {
+            column->pop_back();
+        }
+        key.pop_back();
+        type.pop_back();
+        live_seq.pop_back();
+        owner.pop_back();
+        return last;
+    }
+
+    // 行数，即存活的机器人数
+    uint32_t Size() const {
+        return static_cast<uint32_t>(owner.size());
+    }
+
+    // 热量和血量只记录在最近一次更新时刻last_update的值，需要读取时按闭式推算到时刻now：
+    // 热量随时间降低，超过热量上限期间每次时间推进扣除与推进时长相等的血量。
+    // prev_tick为now之前的最后一次时间推进，调用方保证last_update到prev_tick之间机器人未冷却到上限以下，
+    // 因此只需区分now时刻是否仍然过热；相邻两次时间推进调用时与逐次降热扣血的结果一致
+    void Materialize(uint32_t row, uint32_t now, uint32_t prev_tick) {
+        uint32_t elapsed = now - last_update[row];
+        bool overheated = heat[row] > max_heat[row];
+        if (overheated && elapsed < heat[row] - max_heat[row]) {
+            // 整段时间一直过热，血量减少后若小于0则置0
+            heat[row] -= elapsed;
+            blood[row] = (blood[row] > elapsed) ? (blood[row] - elapsed) : 0;
+        } else {
+            // now时刻已冷却到上限以下，扣血截止到上一次时间推进
+            if (overheated) {
+                blood[row] -= prev_tick - last_update[row];
+            }
+            heat[row] = (heat[row] > elapsed) ? (heat[row] - elapsed) : 0;
+        }
+        last_update[row] = now;
+    }
+
+    // 遍历模式的时间推进：用向量化核函数扫描热量、热量上限、血量三列，
+    // 再按行号顺序把本次推进中血量降为0的行追加到dying。遍历模式下每行状态总是最新，不维护last_update
+    void Tick(uint32_t time_delta, std::vector<uint32_t> &dying) {
+        static const TickKernel kernel = SelectTickKernel();
+        uint32_t size = Size();
+        dead_mask_.assign((size + 63) / 64, 0);
+        kernel(heat.data(), max_heat.data(), blood.data(), size, time_delta, dead_mask_.data());
+        for (size_t word = 0; word < dead_mask_.size(); word++) {
+            for (uint64_t bits = dead_mask_[word]; bits != 0; bits &= bits - 1) {
+                dying.push_back(static_cast<uint32_t>(word * 64 + std::countr_zero(bits)));
+            }
+        }
+    }
+
+private:
+    // 核函数输出的新击毁位图
+    std::vector<uint64_t> dead_mask_;
+};
+
+#endif //UNTITLED1_ROBOT_STORE_H
@@ -0,0 +1,12 @@
+#ifndef UNTITLED1_ROBOT_TYPE_H
+#define UNTITLED1_ROBOT_TYPE_H
+
+#include <cstdint>
+
+// 枚举，设置机器人类型
+enum class RobotType {
+    kInfantry = 0,
+    kEngineer = 1
+};
+
+#endif //UNTITLED1_ROBOT_TYPE_H
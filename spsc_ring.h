@@ -0,0 +1,101 @@
+#ifndef UNTITLED1_SPSC_RING_H
+#define UNTITLED1_SPSC_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 单生产者单消费者的无锁环形队列，容量固定（向上取整为2的幂），队列满时生产者等待，内存占用有上界。
+// 生产者只写tail_，消费者只写head_；双方各自缓存对方的下标，只在看起来满或空时才重新读取，
+// 两个下标放在不同的缓存行上，避免互相使对方的缓存行失效。
+// Push和Pop等待时先让出CPU若干次，仍未就绪再改为短暂休眠，对方长时间没有动作时不会一直占用一个核
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // 生产者调用：放入一个元素，队列满时返回false
+    bool TryPush(const T &value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == slots_.size()) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == slots_.size()) return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 生产者调用：放入一个元素，队列满时等待消费者取走
+    void Push(const T &value) {
+        for (unsigned waits = 0; !TryPush(value); waits++) {
+            Wait(waits);
+        }
+    }
+
+    // 生产者调用：不再放入元素
+    void Close() {
+        closed_.store(true, std::memory_order_release);
+    }
+
+    // 消费者调用：取出一个元素，队列空时返回false
+    bool TryPop(T &value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return false;
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用：取出一个元素，队列空时等待生产者；生产者已关闭且队列已空时返回false
+    bool Pop(T &value) {
+        for (unsigned waits = 0; !TryPop(value); waits++) {
+            // 先读关闭标记再取一次：关闭前放入的元素此时都已可见
+            if (closed_.load(std::memory_order_acquire)) {
+                return TryPop(value);
+            }
+            Wait(waits);
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+    // 连续等待这么多次后改为短暂休眠
+    static constexpr unsigned kSpinLimit = 256;
+
+    static void Wait(unsigned waits) {
+        if (waits < kSpinLimit) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    // 消费者的读取位置及其缓存的生产者写入位置
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+    // 生产者的写入位置及其缓存的消费者读取位置
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+    alignas(kCacheLine) std::atomic<bool> closed_{false};
+};
+
+#endif //UNTITLED1_SPSC_RING_H
@@ -0,0 +1,98 @@
+#ifndef UNTITLED1_TICK_KERNEL_H
+#define UNTITLED1_TICK_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ROBOT_TICK_X86 1
+#endif
+
+// 遍历模式的时间推进核函数：对count个机器人先降热量，热量仍超过上限的再扣血，
+// 即热量、血量各做一次饱和减法，并把血量由非0变为0的机器人在dead_mask中对应的位置1。
+// dead_mask按64位一组，调用前须清零
+using TickKernel = void (*)(uint32_t *heat, const uint32_t *max_heat, uint32_t *blood, size_t count,
+                            uint32_t time_delta, uint64_t *dead_mask);
+
+// 标量处理下标在[begin, end)内的机器人，向量版本用它处理剩余的尾部
+inline void TickRangeScalar(uint32_t *heat, const uint32_t *max_heat, uint32_t *blood, size_t begin, size_t end,
+                            uint32_t time_delta, uint64_t *dead_mask) {
+    for (size_t i = begin; i < end; i++) {
+        heat[i] = (heat[i] > time_delta) ? (heat[i] - time_delta) : 0;
+        if (heat[i] > max_heat[i]) {
+            uint32_t old_blood = blood[i];
+            blood[i] = (old_blood > time_delta) ? (old_blood - time_delta) : 0;
+            if (old_blood != 0 && blood[i] == 0) {
+                dead_mask[i / 64] |= uint64_t{1} << (i % 64);
+            }
+        }
+    }
+}
+
+// 标量版本，在不支持向量指令的CPU上使用
+inline void TickKernelScalar(uint32_t *heat, const uint32_t *max_heat, uint32_t *blood, size_t count,
+                             uint32_t time_delta, uint64_t *dead_mask) {
+    TickRangeScalar(heat, max_heat, blood, 0, count, time_delta, dead_mask);
+}
+
+#ifdef ROBOT_TICK_X86
+// SSE4.1版本，一次处理4个机器人：饱和减法用max(x, dt) - dt，无符号比较a > b用max(a, b) != b
+__attribute__((target("sse4.1")))
+inline void TickKernelSse41(uint32_t *heat, const uint32_t *max_heat, uint32_t *blood, size_t count,
+                            uint32_t time_delta, uint64_t *dead_mask) {
+    const __m128i delta = _mm_set1_epi32(static_cast<int>(time_delta));
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(heat + i));
+        __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(max_heat + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blood + i));
+        h = _mm_sub_epi32(_mm_max_epu32(h, delta), delta);
+        __m128i not_over = _mm_cmpeq_epi32(_mm_max_epu32(h, m), m);
+        __m128i damaged = _mm_sub_epi32(_mm_max_epu32(b, delta), delta);
+        __m128i new_b = _mm_blendv_epi8(damaged, b, not_over);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(heat + i), h);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(blood + i), new_b);
+        __m128i died = _mm_andnot_si128(_mm_cmpeq_epi32(b, zero), _mm_cmpeq_epi32(new_b, zero));
+        uint64_t bits = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(died)));
+        dead_mask[i / 64] |= bits << (i % 64);
+    }
+    TickRangeScalar(heat, max_heat, blood, i, count, time_delta, dead_mask);
+}
+
+// AVX2版本，一次处理8个机器人，逻辑与SSE4.1版本相同
+__attribute__((target("avx2")))
+inline void TickKernelAvx2(uint32_t *heat, const uint32_t *max_heat, uint32_t *blood, size_t count,
+                           uint32_t time_delta, uint64_t *dead_mask) {
+    const __m256i delta = _mm256_set1_epi32(static_cast<int>(time_delta));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(heat + i));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(max_heat + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blood + i));
+        h = _mm256_sub_epi32(_mm256_max_epu32(h, delta), delta);
+        __m256i not_over = _mm256_cmpeq_epi32(_mm256_max_epu32(h, m), m);
+        __m256i damaged = _mm256_sub_epi32(_mm256_max_epu32(b, delta), delta);
+        __m256i new_b = _mm256_blendv_epi8(damaged, b, not_over);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(heat + i), h);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(blood + i), new_b);
+        __m256i died = _mm256_andnot_si256(_mm256_cmpeq_epi32(b, zero), _mm256_cmpeq_epi32(new_b, zero));
+        uint64_t bits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(died)));
+        dead_mask[i / 64] |= bits << (i % 64);
+    }
+    TickRangeScalar(heat, max_heat, blood, i, count, time_delta, dead_mask);
+}
+#endif
+
+// 按CPU支持的指令集选择核函数，只在首次调用时检测
+inline TickKernel SelectTickKernel() {
+#ifdef ROBOT_TICK_X86
+    if (__builtin_cpu_supports("avx2")) return TickKernelAvx2;
+    if (__builtin_cpu_supports("sse4.1")) return TickKernelSse41;
+#endif
+    return TickKernelScalar;
+}
+
+#endif //UNTITLED1_TICK_KERNEL_H
@@ -0,0 +1,144 @@
+#ifndef UNTITLED1_WORK_STEALING_POOL_H
+#define UNTITLED1_WORK_STEALING_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程有自己的任务队列，从队尾取自己的任务（刚放入的任务数据还在缓存中），
+// 自己的队列空了再从其他线程的队首窃取最早放入的任务。任务内部调用Submit时放入当前线程自己的队列，
+// 外部线程调用Submit时轮流放入各个队列。各队列各用一把锁，只有窃取时才会和队列的主人竞争
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned threads) {
+        threads = std::max(threads, 1u);
+        for (unsigned i = 0; i < threads; i++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            workers_.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    // 等待全部任务完成后结束工作线程
+    ~WorkStealingPool() {
+        Wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (std::thread &worker: workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    size_t ThreadCount() const {
+        return workers_.size();
+    }
+
+    // 放入一个任务，可以在任务内部调用
+    void Submit(Task task) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        size_t index = current_pool_ == this
+                           ? current_index_
+                           : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            signal_.fetch_add(1, std::memory_order_relaxed);
+        }
+        work_cv_.notify_one();
+    }
+
+    // 等待已放入的任务以及它们运行中放入的任务全部完成，不能在任务内部调用
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // 当前线程所属的线程池和队列下标，不是工作线程时为空
+    static inline thread_local WorkStealingPool *current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+
+    std::vector<std::unique_ptr<Queue> > queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+    // 已放入但尚未完成的任务数
+    std::atomic<size_t> pending_{0};
+    // 每放入一个任务加一，空闲线程据此判断睡眠期间是否来了新任务；只在持有mutex_时修改
+    std::atomic<uint64_t> signal_{0};
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stop_ = false;
+
+    // 先取自己队尾的任务，没有再依次从其他队列的队首窃取
+    bool TryTake(size_t self, Task &task) {
+        {
+            Queue &own = *queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t step = 1; step < queues_.size(); step++) {
+            Queue &victim = *queues_[(self + step) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(size_t self) {
+        current_pool_ = this;
+        current_index_ = self;
+        Task task;
+        for (;;) {
+            // 先记下计数再找任务：找不到任务后计数若已变化，说明期间放入了新任务，不能睡眠
+            uint64_t seen = signal_.load(std::memory_order_acquire);
+            if (TryTake(self, task)) {
+                task();
+                task = nullptr;
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    done_cv_.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&] { return stop_ || signal_.load(std::memory_order_relaxed) != seen; });
+            if (stop_) return;
+        }
+    }
+};
+
+#endif //UNTITLED1_WORK_STEALING_POOL_H